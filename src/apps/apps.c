@@ -6,6 +6,7 @@
 #include "about.h"
 #include "appslist.h"
 #include "bandscan.h"
+#include "bcscan.h"
 #include "chcfg.h"
 #include "chlist.h"
 #include "chscan.h"
@@ -61,6 +62,7 @@ const AppType_t appsAvailableToRun[RUN_APPS_COUNT] = {
     APP_LOOT_LIST, //
     APP_CH_SCAN,   //
     APP_BAND_SCAN, //
+    APP_BC_SCAN,   //
     APP_ABOUT,     //
 };
 
@@ -88,6 +90,8 @@ const App apps[APPS_COUNT] = {
                      CHSCAN_key, CHSCAN_deinit, true},
     [APP_BAND_SCAN] = {"Band Scan", BANDSCAN_init, BANDSCAN_update,
                        BANDSCAN_render, BANDSCAN_key, BANDSCAN_deinit, true},
+    [APP_BC_SCAN] = {"BC Scan", BCSCAN_init, BCSCAN_update, BCSCAN_render,
+                     BCSCAN_key, BCSCAN_deinit, true},
     [APP_FC] = {"FC", FC_init, FC_update, FC_render, FC_key, FC_deinit, true},
     [APP_VFO1] = {"1 VFO", VFO1_init, VFO1_update, VFO1_render, VFO1_key, NULL,
                   true, true},
@@ -4,7 +4,7 @@
 #include "../driver/keyboard.h"
 #include "../radio.h"
 
-#define RUN_APPS_COUNT 8
+#define RUN_APPS_COUNT 9
 
 typedef enum {
   APP_NONE,
@@ -22,6 +22,7 @@ typedef enum {
   APP_SETTINGS,
   APP_VFO1,
   APP_ABOUT,
+  APP_BC_SCAN,
 
   APPS_COUNT,
 } AppType_t;
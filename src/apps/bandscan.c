@@ -52,6 +52,9 @@ bool BANDSCAN_key(KEY_Code_t key, Key_State_t state) {
       return true;
     case KEY_SIDE1:
       LOOT_BlacklistLast();
+      if (gLastActiveLoot) {
+        SCAN_Exclude(gLastActiveLoot->f);
+      }
       SCAN_Next(true);
       return true;
     case KEY_SIDE2:
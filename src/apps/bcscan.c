@@ -0,0 +1,189 @@
+#include "bcscan.h"
+#include "../driver/st7565.h"
+#include "../driver/system.h"
+#include "../helper/channels.h"
+#include "../helper/measurements.h"
+#include "../helper/seek.h"
+#include "../radio.h"
+#include "../ui/graphics.h"
+#include "../ui/statusline.h"
+#include "apps.h"
+#include "chlist.h"
+
+#define LIST_Y 30
+#define LIST_LINES 6
+#define LINE_H 6
+
+static uint8_t rangeIndex;
+static uint8_t cursor;
+
+static bool canSeek() {
+  return ctx->radio_type == RADIO_SI4732 || ctx->radio_type == RADIO_BK1080;
+}
+
+static void tuneToStation(const Station *s, bool save) {
+  if (ctx->radio_type == RADIO_SI4732) {
+    RADIO_SetParam(ctx, PARAM_MODULATION, s->mode, save);
+  }
+  RADIO_SetParam(ctx, PARAM_FREQUENCY, s->f, save);
+  RADIO_ApplySettings(ctx);
+}
+
+// seek перестраивает чип в обход VFO, возвращаем настройки VFO
+static void restoreVfo() {
+  RADIO_SetParam(ctx, PARAM_MODULATION, ctx->modulation, false);
+  RADIO_SetParam(ctx, PARAM_FREQUENCY, ctx->frequency, false);
+  RADIO_ApplySettings(ctx);
+}
+
+static void toggleSeek() {
+  if (SEEK_IsRunning()) {
+    SEEK_Stop();
+    restoreVfo();
+    return;
+  }
+  if (!SEEK_Start(ctx->radio_type, rangeIndex)) {
+    STATUSLINE_SetText("%s: no seek on %s", SEEK_RANGES[rangeIndex].name,
+                       RADIO_GetParamValueString(ctx, PARAM_RADIO));
+  }
+}
+
+static void saveAll() {
+  const uint16_t saved =
+      SEEK_SaveAll(ctx->radio_type, gSettings.currentScanlist);
+  FillRect(0, LCD_YCENTER - 4, LCD_WIDTH, 9, C_FILL);
+  PrintMediumBoldEx(LCD_XCENTER, LCD_YCENTER + 3, POS_C, C_INVERT, "Saved: %u",
+                    saved);
+  ST7565_Blit();
+  SYS_DelayMs(2000);
+}
+
+void BCSCAN_init(void) {
+  if (cursor >= SEEK_Count()) {
+    cursor = 0;
+  }
+}
+
+void BCSCAN_deinit(void) {
+  if (SEEK_IsRunning()) {
+    SEEK_Stop();
+    restoreVfo();
+  }
+}
+
+void BCSCAN_update(void) {
+  if (SEEK_Update()) {
+    if (!SEEK_IsRunning()) {
+      restoreVfo();
+    }
+    gRedrawScreen = true;
+  }
+}
+
+bool BCSCAN_key(KEY_Code_t key, Key_State_t state) {
+  const Station *s = SEEK_Get(cursor);
+  const bool busy = SEEK_IsRunning();
+
+  if (state == KEY_LONG_PRESSED) {
+    switch (key) {
+    case KEY_0:
+      if (!busy) {
+        SEEK_Clear();
+        cursor = 0;
+      }
+      return true;
+    case KEY_5:
+      if (!busy && SEEK_Count()) {
+        saveAll();
+      }
+      return true;
+    default:
+      break;
+    }
+  }
+
+  if (state == KEY_RELEASED || state == KEY_LONG_PRESSED_CONT) {
+    switch (key) {
+    case KEY_UP:
+    case KEY_DOWN:
+      if (!busy && SEEK_Count()) {
+        cursor = IncDecU(cursor, 0, SEEK_Count(), key != KEY_UP);
+        tuneToStation(SEEK_Get(cursor), false);
+      }
+      return true;
+    default:
+      break;
+    }
+  }
+
+  if (state == KEY_RELEASED) {
+    switch (key) {
+    case KEY_MENU:
+      if (canSeek()) {
+        toggleSeek();
+      }
+      return true;
+    case KEY_1:
+    case KEY_7:
+      if (!busy) {
+        rangeIndex = IncDecU(rangeIndex, 0, SEEK_RANGES_COUNT, key == KEY_1);
+      }
+      return true;
+    case KEY_5:
+      if (!busy && s) {
+        tuneToStation(s, false);
+        gChListFilter = TYPE_FILTER_CH_SAVE;
+        APPS_run(APP_CH_LIST);
+      }
+      return true;
+    case KEY_PTT:
+      if (!busy && s) {
+        tuneToStation(s, true);
+        APPS_run(APP_VFO1);
+      }
+      return true;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+static void renderList() {
+  const uint8_t count = SEEK_Count();
+  const uint8_t first = cursor < LIST_LINES ? 0 : cursor - LIST_LINES + 1;
+  for (uint8_t i = 0; i < LIST_LINES && first + i < count; ++i) {
+    const Station *s = SEEK_Get(first + i);
+    const uint8_t y = LIST_Y + i * LINE_H;
+    FSmall(1, y, POS_L, s->f);
+    PrintSmallEx(LCD_WIDTH - 1, y, POS_R, C_FILL, "%udBu %udB", s->rssi,
+                 s->snr);
+    if (first + i == cursor && !SEEK_IsRunning()) {
+      FillRect(0, y - 5, LCD_WIDTH, LINE_H, C_INVERT);
+    }
+  }
+}
+
+void BCSCAN_render(void) {
+  const SeekRange *r = &SEEK_RANGES[rangeIndex];
+
+  if (!canSeek()) {
+    PrintMediumEx(LCD_XCENTER, 28, POS_C, C_FILL, "Need SI4732/BK1080");
+    PrintSmallEx(LCD_XCENTER, 36, POS_C, C_FILL, "VFO for broadcast seek");
+    return;
+  }
+
+  PrintMediumBoldEx(0, 14, POS_L, C_FILL, "%s", r->name);
+  PrintSmallEx(LCD_WIDTH - 1, 14, POS_R, C_FILL, "%u st", SEEK_Count());
+
+  if (SEEK_IsRunning()) {
+    FSmall(LCD_XCENTER, 14, POS_C, SEEK_GetF());
+    DrawRect(0, 17, LCD_WIDTH, 5, C_FILL);
+    FillRect(1, 18, (LCD_WIDTH - 2) * SEEK_GetProgress() / 100, 3, C_FILL);
+  } else if (SEEK_GetLastTime()) {
+    PrintSmallEx(LCD_XCENTER, 14, POS_C, C_FILL, "%u.%us",
+                 SEEK_GetLastTime() / 1000, SEEK_GetLastTime() % 1000 / 100);
+  }
+
+  renderList();
+}
@@ -37,6 +37,7 @@ typedef enum {
   MEM_P_CAL_L,
   MEM_P_CAL_M,
   MEM_PPM,
+  MEM_PRIORITY,
   MEM_RADIO,
   MEM_READONLY,
   MEM_RX_CODE,
@@ -117,6 +118,8 @@ static uint32_t getValue(MemProp p) {
     return gChEd.allowTx;
   case MEM_READONLY:
     return gChEd.meta.readonly;
+  case MEM_PRIORITY:
+    return gChEd.meta.priority;
   case MEM_TYPE:
     return gChEd.meta.type;
   case MEM_BANK:
@@ -236,6 +239,9 @@ static void getValS(const MenuItem *item, char *buf, uint8_t _) {
   case MEM_READONLY:
     snprintf(buf, 15, YES_NO[gChEd.meta.readonly]);
     break;
+  case MEM_PRIORITY:
+    snprintf(buf, 15, YES_NO[gChEd.meta.priority]);
+    break;
   case MEM_TYPE:
     snprintf(buf, 15, CH_TYPE_NAMES[gChEd.meta.type]);
     break;
@@ -300,6 +306,9 @@ static void setValue(MemProp p, uint32_t v) {
   case MEM_READONLY:
     gChEd.meta.readonly = v;
     break;
+  case MEM_PRIORITY:
+    gChEd.meta.priority = v;
+    break;
   case MEM_TYPE:
     gChEd.meta.type = v;
     break;
@@ -364,6 +373,7 @@ static MenuItem menuChVfo[] = {
 
     {"Radio", .submenu = &radioMenu},
 
+    {"Priority", MEM_PRIORITY, getValS, updVal},
     {"Readonly", MEM_READONLY, getValS, updVal},
     {"Save CH", .action = save},
 };
@@ -468,6 +478,9 @@ static void updVal(const MenuItem *item, bool inc) {
     break;
   case MEM_READONLY:
     break;
+  case MEM_PRIORITY:
+    setValue(item->setting, !v);
+    break;
   case MEM_RADIO:
     break;
   default:
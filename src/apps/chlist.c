@@ -60,7 +60,7 @@ static const Symbol typeIcons[] = {
 };
 
 static inline uint16_t getChannelNumber(uint16_t menuIndex) {
-  return gScanlist[menuIndex];
+  return CHANNELS_ScanlistAt(menuIndex);
 }
 
 static void renderItem(uint16_t index, uint8_t i, bool isCurrent) {
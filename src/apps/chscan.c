@@ -4,28 +4,171 @@
 #include "../driver/uart.h"
 #include "../helper/channels.h"
 #include "../helper/lootlist.h"
+#include "../helper/measurements.h"
+#include "../helper/scan.h"
+#include "../helper/scanplan.h"
+#include "../misc.h"
 #include "../radio.h"
 #include "../scheduler.h"
 #include "../ui/components.h"
 #include "../ui/graphics.h"
 #include "apps.h"
 
+#define PREFETCH_SIZE 4
+#define SETTLE_MS 20 // RSSI/squelch BK4819 после перестройки
+
 CH activeCh;
 
+// Следующие каналы из scanlist, читаются из EEPROM пока ждём на текущем
+typedef struct {
+  int16_t num;
+  CH ch;
+} PrefetchSlot;
+
+static PrefetchSlot prefetch[PREFETCH_SIZE];
+static uint16_t prefetchRevision;
+
 static bool lastListenState;
 static uint32_t timeout = 0;
+static uint32_t settleTimeout = 0;
 static bool isWaiting;
+static bool isPlanned; // текущий канал настроен из плана, VFO не загружен
+static bool isPriority; // слушаем приоритетный канал вне scanlist
+
+static void prefetchReset() {
+  prefetchRevision = CHANNELS_GetRevision();
+  for (uint8_t i = 0; i < PREFETCH_SIZE; ++i) {
+    prefetch[i].num = -1;
+  }
+}
+
+static PrefetchSlot *prefetchFind(int16_t num) {
+  // канал сохранили после чтения: слоты устарели
+  if (prefetchRevision != CHANNELS_GetRevision()) {
+    prefetchReset();
+  }
+  for (uint8_t i = 0; i < PREFETCH_SIZE; ++i) {
+    if (prefetch[i].num == num) {
+      return &prefetch[i];
+    }
+  }
+  return NULL;
+}
+
+// Loads one missing upcoming channel per call, keeps EEPROM access short
+static void prefetchStep() {
+  int16_t upcoming[PREFETCH_SIZE];
+  int16_t num = CHANNELS_GetCurrentScanlistCH();
+  uint8_t n = MIN(PREFETCH_SIZE, gScanlistSize);
+
+  for (uint8_t i = 0; i < n; ++i) {
+    num = CHANNELS_ScanlistStep(num, true);
+    upcoming[i] = num;
+  }
+
+  for (uint8_t i = 0; i < n; ++i) {
+    if (prefetchFind(upcoming[i]) || SCANPLAN_Has(upcoming[i])) {
+      continue;
+    }
+    // вытесняем слот, который больше не нужен
+    for (uint8_t s = 0; s < PREFETCH_SIZE; ++s) {
+      bool needed = false;
+      for (uint8_t k = 0; k < n; ++k) {
+        if (prefetch[s].num == upcoming[k]) {
+          needed = true;
+          break;
+        }
+      }
+      if (!needed) {
+        CHANNELS_Load(upcoming[i], &prefetch[s].ch);
+        prefetch[s].num = upcoming[i];
+        return;
+      }
+    }
+    return;
+  }
+}
+
+static void loadCurrentCh(int16_t num) {
+  PrefetchSlot *slot = prefetchFind(num);
+  if (slot) {
+    activeCh = slot->ch;
+    slot->num = -1;
+  } else {
+    CHANNELS_Load(num, &activeCh);
+  }
+  uint8_t vfoNum = RADIO_GetCurrentVFONumber(&gRadioState);
+  RADIO_ChannelToVFO(&gRadioState, vfoNum, num, &activeCh);
+  RADIO_ApplySettings(&gRadioState.vfos[vfoNum].context);
+  isPlanned = false;
+}
+
+static void applyCurrentCh() {
+  int16_t num = CHANNELS_GetCurrentScanlistCH();
+  if (num < 0) {
+    return;
+  }
+  ExtendedVFOContext *v =
+      &gRadioState.vfos[RADIO_GetCurrentVFONumber(&gRadioState)];
+  isPriority = false;
+  if (SCANPLAN_Apply(num, &v->context)) {
+    v->channel_index = num;
+    isPlanned = true;
+  } else {
+    loadCurrentCh(num);
+  }
+  // даём squelch устояться вместо блокирующей задержки
+  SetTimeout(&settleTimeout, SETTLE_MS);
+}
 
-static void loadCurrentCh() {
-  RADIO_LoadChannelToVFO(&gRadioState, RADIO_GetCurrentVFONumber(&gRadioState),
-                         CHANNELS_GetCurrentScanlistCH());
+// Приоритетные каналы проверяются по EDF между хопами и при прослушивании:
+// обход scanlist из сотен каналов длиннее PRIORITY_PERIOD
+static bool checkPriority() {
+  if (isPriority) {
+    return false;
+  }
+  const uint32_t curF = RADIO_GetParam(ctx, PARAM_FREQUENCY);
+  const uint8_t sq = ctx->squelch.value;
+  uint32_t f = 0;
+  // порог открытия - уровень squelch канала, при 0 открыт был бы любой шум
+  const bool open = SCAN_CheckPriority(GetSql(sq ? sq : 1).ro, &f);
+  if (!f) {
+    return false; // проверка не подошла, чип не трогали
+  }
+  if (!open || f == curF) {
+    RADIO_SetParam(ctx, PARAM_FREQUENCY, curF, false);
+    RADIO_ApplySettings(ctx);
+    SetTimeout(&settleTimeout, SETTLE_MS);
+    return true;
+  }
+
+  const int16_t num = CHANNELS_FindPriority(f, &activeCh);
+  if (num < 0) {
+    RADIO_SetParam(ctx, PARAM_FREQUENCY, curF, false);
+    RADIO_ApplySettings(ctx);
+  } else {
+    uint8_t vfoNum = RADIO_GetCurrentVFONumber(&gRadioState);
+    RADIO_ChannelToVFO(&gRadioState, vfoNum, num, &activeCh);
+    RADIO_ApplySettings(&gRadioState.vfos[vfoNum].context);
+    isPlanned = false;
+    isPriority = true;
+    isWaiting = false;
+    // после приоритетного обход продолжится с текущего канала scanlist
+    lastListenState = false;
+    SetTimeout(&timeout, 0);
+  }
+  SetTimeout(&settleTimeout, SETTLE_MS);
+  return true;
 }
 
 static void nextWithTimeout() {
   if (lastListenState != vfo->is_open) {
     lastListenState = vfo->is_open;
     if (vfo->is_open) {
-      loadCurrentCh();
+      if (isPlanned) {
+        // слушаем: нужен полный канал (имя, TX, коды)
+        loadCurrentCh(CHANNELS_GetCurrentScanlistCH());
+      }
       isWaiting = true;
     }
     SetTimeout(&timeout, vfo->is_open
@@ -35,6 +178,7 @@ static void nextWithTimeout() {
 
   if (CheckTimeout(&timeout)) {
     CHANNELS_Next(true);
+    applyCurrentCh();
     isWaiting = false;
     SetTimeout(&timeout, 0);
     return;
@@ -43,23 +187,40 @@ static void nextWithTimeout() {
 
 void CHSCAN_init(void) {
   CHANNELS_LoadScanlist(TYPE_FILTER_CH, gSettings.currentScanlist);
-  loadCurrentCh();
+  prefetchReset();
+  SCAN_LoadPriority();
+  if (!SCANPLAN_IsValid()) {
+    SCANPLAN_Compile();
+  }
+  applyCurrentCh();
 }
 
-void CHSCAN_deinit(void) {}
-
-static uint32_t lastSqCheck;
+// План заполняет только RX-поля, возвращаем VFO полный канал
+void CHSCAN_deinit(void) {
+  if (isPlanned && gScanlistSize) {
+    loadCurrentCh(CHANNELS_GetCurrentScanlistCH());
+  }
+}
 
 void CHSCAN_update(void) {
   RADIO_UpdateMultiwatch(&gRadioState);
   RADIO_CheckAndSaveVFO(&gRadioState);
 
-  nextWithTimeout();
-  SYS_DelayMs(SQL_DELAY);
-  if (Now() - lastSqCheck >= 55) {
-    RADIO_UpdateSquelch(&gRadioState);
-    lastSqCheck = Now();
+  if (!gScanlistSize) {
+    return;
+  }
+
+  if (!CheckTimeout(&settleTimeout)) {
+    prefetchStep();
+    return;
+  }
+
+  if (checkPriority()) {
+    return;
   }
+
+  RADIO_UpdateSquelch(&gRadioState);
+  nextWithTimeout();
   gRedrawScreen = true;
 }
 
@@ -70,7 +231,9 @@ bool CHSCAN_key(KEY_Code_t key, Key_State_t state) {
     gSettings.currentScanlist = CHANNELS_ScanlistByKey(
         gSettings.currentScanlist, key, longHeld && !simpleKeypress);
     CHANNELS_LoadScanlist(TYPE_FILTER_CH, gSettings.currentScanlist);
-    loadCurrentCh();
+    prefetchReset();
+    SCANPLAN_Compile();
+    applyCurrentCh();
     SETTINGS_DelayedSave();
     isWaiting = false;
     return true;
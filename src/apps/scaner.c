@@ -2,6 +2,7 @@
 #include "../driver/st7565.h"
 #include "../driver/uart.h"
 #include "../helper/bands.h"
+#include "../helper/finder.h"
 #include "../helper/lootlist.h"
 #include "../helper/measurements.h"
 #include "../helper/regs-menu.h"
@@ -16,6 +17,8 @@
 #include "finput.h"
 #include <stdint.h>
 
+#define PAN_COLUMNS 8 // шаг панорамы анализатора, курсор у края
+
 static VMinMax minMaxRssi;
 
 static bool selStart = true;
@@ -23,6 +26,7 @@ static bool selStart = true;
 static uint32_t cursorRangeTimeout = 0;
 
 static bool isAnalyserMode = false;
+static bool isWaterfall = false;
 
 static uint8_t scanAFC;
 // static uint32_t scanDelay;
@@ -93,6 +97,18 @@ bool SCANER_key(KEY_Code_t key, Key_State_t state) {
     case KEY_5:
       selStart = !selStart;
       return true;
+    case KEY_4:
+      SCAN_SetTwoPass(!SCAN_IsTwoPass());
+      return true;
+    case KEY_1:
+      FINDER_Toggle(!FINDER_IsOn());
+      return true;
+    case KEY_7:
+      SCAN_SetAdaptive(!SCAN_IsAdaptive());
+      return true;
+    case KEY_STAR:
+      isWaterfall = !isWaterfall;
+      return true;
     case KEY_0:
       gChListFilter = TYPE_FILTER_BAND;
       APPS_run(APP_CH_LIST);
@@ -119,6 +135,9 @@ bool SCANER_key(KEY_Code_t key, Key_State_t state) {
     case KEY_1:
     case KEY_7:
       // delay = AdjustU(delay, 0, 10000, key == KEY_1 ? 100 : -100);
+      if (isAnalyserMode && state == KEY_RELEASED) {
+        SP_NextTraceMode(key == KEY_1);
+      }
       return true;
     case KEY_3:
     case KEY_9:
@@ -128,7 +147,12 @@ bool SCANER_key(KEY_Code_t key, Key_State_t state) {
       return true;
     case KEY_UP:
     case KEY_DOWN:
-      CUR_Move(key == KEY_UP);
+      // курсор у края экрана: анализатор листает диапазон, спектр
+      // сдвигается без пересканирования
+      if (!CUR_Move(key == KEY_UP) && isAnalyserMode) {
+        SCAN_Pan(key == KEY_UP ? PAN_COLUMNS : -PAN_COLUMNS);
+        *BANDS_RangePeek() = gCurrentBand;
+      }
       cursorRangeTimeout = Now() + 2000;
       return true;
     default:
@@ -142,6 +166,8 @@ bool SCANER_key(KEY_Code_t key, Key_State_t state) {
       if (isAnalyserMode) {
         // delay = scanDelay;
         BK4819_SetAFC(scanAFC);
+        // следы (PEAK/MIN/AVG) только для анализатора
+        SP_SetTraceMode(TRACE_LIVE);
       } else {
         // scanDelay = delay;
         scanAFC = BK4819_GetAFC();
@@ -158,6 +184,9 @@ bool SCANER_key(KEY_Code_t key, Key_State_t state) {
       return true;
     case KEY_SIDE1:
       LOOT_BlacklistLast();
+      if (gLastActiveLoot) {
+        SCAN_Exclude(gLastActiveLoot->f);
+      }
       SCAN_Next(true);
       return true;
     case KEY_SIDE2:
@@ -202,6 +231,14 @@ static void renderAnalyzerUI() {
                Rssi2DBm(mm.vMax));
   PrintSmallEx(LCD_WIDTH, 24, POS_R, C_FILL, "%3u %+3d", mm.vMin,
                Rssi2DBm(mm.vMin));
+
+  // маркер пика по выбранному следу, в верхней строке над столбцами
+  const uint8_t px = SP_GetPeakX();
+  const uint32_t pf = SP_X2F(px);
+  PrintSmallEx(0, 12, POS_L, C_FILL, "%s %u.%05u %+d",
+               TRACE_MODE_NAMES[SP_GetTraceMode()], pf / MHZ, pf % MHZ,
+               Rssi2DBm(SP_GetTraceValue(px)));
+  DrawVLine(px, SPECTRUM_Y + 24, 2, C_INVERT);
 }
 
 void SCANER_render(void) {
@@ -216,10 +253,14 @@ void SCANER_render(void) {
     minMaxRssi = SP_GetMinMax();
   }
 
-  SP_Render(&gCurrentBand, minMaxRssi);
+  if (isWaterfall && !isAnalyserMode) {
+    SP_RenderWaterfall(&gCurrentBand);
+  } else {
+    SP_Render(&gCurrentBand, minMaxRssi);
+  }
 
-  // top
-  if (gLastActiveLoot) {
+  // top; анализатор loot не обновляет, строка занята маркером
+  if (gLastActiveLoot && !isAnalyserMode) {
     UI_DrawLoot(gLastActiveLoot, LCD_XCENTER, 14, POS_C);
   }
 
@@ -227,10 +268,31 @@ void SCANER_render(void) {
 
   PrintSmallEx(LCD_WIDTH, 12, POS_R, C_FILL, "%u.%02uk", step / 100,
                step % 100);
+  if (!isAnalyserMode) {
+    PrintSmallEx(LCD_WIDTH, 18, POS_R, C_FILL, "%s%s%s",
+                 FINDER_IsOn() ? "HW " : "", SCAN_IsAdaptive() ? "AD " : "",
+                 SCAN_IsTwoPass() ? "2P" : "");
+  }
   if (BANDS_RangeIndex() > 0) {
     PrintSmallEx(0, 18, POS_L, C_FILL, "Zoom %u", BANDS_RangeIndex() + 1);
   }
-  PrintSmallEx(0, 24, POS_L, C_FILL, "CPS %u", SCAN_GetCps());
+  const uint32_t cps = SCAN_GetCps();
+  if (isAnalyserMode || !SCAN_GetThinkingPercent()) {
+    PrintSmallEx(0, 24, POS_L, C_FILL, "CPS %u", cps);
+  } else {
+    // доля времени на проверку squelch
+    PrintSmallEx(0, 24, POS_L, C_FILL, "CPS %u SQ%u%%", cps,
+                 SCAN_GetThinkingPercent());
+  }
+
+  if (!isAnalyserMode && SCAN_GetPriorityCount()) {
+    // худшая задержка проверки приоритетных и доля времени на них
+    uint16_t lat;
+    uint8_t cost;
+    SCAN_GetPriorityStats(&lat, &cost);
+    PrintSmallEx(LCD_WIDTH, 24, POS_R, C_FILL, "P%u %ums %u%%",
+                 SCAN_GetPriorityCount(), lat, cost);
+  }
 
   if (isAnalyserMode) {
     renderAnalyzerUI();
@@ -69,6 +69,7 @@ static const MenuItem radioMenuItems[] = {
     {"DTMF decode", SETTING_DTMFDECODE, getValS, updateValS},
     {"Filter bound", SETTING_BOUND240_280, getValS, updateValS},
     {"SI power off", SETTING_SI4732POWEROFF, getValS, updateValS},
+    {"SI keep SSB", SETTING_SI4732KEEPSSB, getValS, updateValS},
     {"STE", SETTING_STE, getValS, updateValS},
     {"Tone local", SETTING_TONELOCAL, getValS, updateValS},
     {"Roger", SETTING_ROGER, getValS, updateValS},
@@ -2,8 +2,10 @@
 #include "../dcs.h"
 #include "../driver/gpio.h"
 #include "../driver/uart.h"
+#include "../external/printf/printf.h"
 #include "../helper/bands.h"
 #include "../helper/channels.h"
+#include "../helper/finder.h"
 #include "../helper/measurements.h"
 #include "../helper/numnav.h"
 #include "../helper/regs-menu.h"
@@ -38,12 +40,21 @@ static uint32_t lastSqCheck;
 static const Step liveStep = STEP_5_0kHz;
 
 void VFO1_update(void) {
-  RADIO_UpdateMultiwatch(&gRadioState);
   RADIO_CheckAndSaveVFO(&gRadioState);
+  if (FINDER_Update(!vfo->is_open && ctx->radio_type == RADIO_BK4819 &&
+                    !ctx->tx_state.is_active &&
+                    RADIO_IsMultiwatchIdle(&gRadioState))) {
+    return;
+  }
+  RADIO_UpdateMultiwatch(&gRadioState);
 
   if (!gSettings.mWatch && Now() - lastSqCheck >= SQL_DELAY) {
     RADIO_UpdateSquelch(&gRadioState);
     lastSqCheck = Now();
+    if (gMonitorMode && gSettings.showLevelInVFO) {
+      SP_ShiftGraph(-1);
+      SP_AddGraphPoint(&vfo->msm);
+    }
   }
 
   if (Now() - lastRender >= 1000) {
@@ -107,6 +118,7 @@ bool VFO1_key(KEY_Code_t key, Key_State_t state) {
     case KEY_1:
       // gChListFilter = TYPE_FILTER_BAND;
       // APPS_run(APP_CH_LIST);
+      FINDER_Toggle(!FINDER_IsOn());
       return true;
     case KEY_2:
       if (gCurrentApp == APP_VFO1) {
@@ -225,6 +237,19 @@ static void renderProModeInfo(uint8_t y) {
   }
 }
 
+// Длительность цикла мультивотча и прогрев остальных VFO, мс
+static void renderMultiwatchStats(void) {
+  char buf[24] = "";
+  uint8_t len = 0;
+  for (uint8_t i = 0; i < gRadioState.num_vfos && len < sizeof(buf) - 4; ++i) {
+    if (i != gRadioState.active_vfo_index) {
+      len += snprintf(buf + len, sizeof(buf) - len, " %u",
+                      RADIO_GetMultiwatchDwell(&gRadioState, i));
+    }
+  }
+  STATUSLINE_SetText("MW %ums:%s", gRadioState.cycle_time, buf);
+}
+
 void VFO1_render(void) {
   const uint8_t BASE = 40;
 
@@ -235,6 +260,8 @@ void VFO1_render(void) {
   } else if (gSettings.iAmPro &&
              (!gSettings.mWatch || vfo->is_open)) { // NOTE mwatch is temporary
     STATUSLINE_RenderRadioSettings();
+  } else if (gSettings.mWatch) {
+    renderMultiwatchStats();
   } else {
     STATUSLINE_SetText("Radio: %s",
                        RADIO_GetParamValueString(ctx, PARAM_RADIO));
@@ -12,6 +12,12 @@
 
 static uint16_t gBK4819_GpioOutState;
 static Filter selectedFilter = FILTER_OFF;
+static uint32_t oldFreq;
+static uint8_t oldMod = 255;
+
+static BK4819_Snapshot *recording;
+static const BK4819_Snapshot *lastSnapshot; // chip state = this snapshot
+static bool applying;
 
 static const uint16_t modTypeReg47Values[] = {
     [MOD_FM] = BK4819_AF_FM,      //
@@ -168,8 +174,35 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register) {
   return v;
 }
 
+// REG_30 (enable bits, retune), REG_33 (shared GPIO), REG_02 (irq clear)
+// are actions/shared state, not per-VFO settings
+static inline bool isSnapshotReg(BK4819_REGISTER_t reg) {
+  return reg != BK4819_REG_30 && reg != BK4819_REG_33 && reg != BK4819_REG_02;
+}
+
+static void snapshotPut(BK4819_REGISTER_t reg, uint16_t value) {
+  for (uint8_t i = 0; i < recording->count; ++i) {
+    if (recording->regs[i].reg == reg) {
+      recording->regs[i].value = value;
+      return;
+    }
+  }
+  if (recording->count >= BK4819_SNAPSHOT_MAX) {
+    recording->valid = false;
+    return;
+  }
+  recording->regs[recording->count++] = (BK4819_RegWrite){reg, value};
+}
+
 void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data) {
   // Log("  BK W 0x%02x: 0x%04x", Register, Data);
+  if (isSnapshotReg(Register)) {
+    if (recording) {
+      snapshotPut(Register, Data);
+    } else if (!applying) {
+      lastSnapshot = NULL;
+    }
+  }
   GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
   GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
   SYSTICK_Delay250ns(1);
@@ -509,8 +542,6 @@ void BK4819_XtalSet(XtalMode mode) {
   BK4819_WriteRegister(0x3D, ifset);
 }
 
-static uint8_t oldMod = 255;
-
 void BK4819_SetModulation(ModulationType type) {
   if (oldMod == type) {
     return;
@@ -563,6 +594,8 @@ void BK4819_RX_TurnOn(void) {
 void BK4819_SelectFilterEx(Filter filter) {
   // Log("BK ---- SEL flt %u", filter);
 
+  selectedFilter = filter;
+
   // for single write to 0x33
   const uint16_t PIN_BIT_VHF = 0x40U >> BK4819_GPIO4_PIN32_VHF_LNA;
   const uint16_t PIN_BIT_UHF = 0x40U >> BK4819_GPIO3_PIN31_UHF_LNA;
@@ -582,9 +615,13 @@ void BK4819_SelectFilterEx(Filter filter) {
   BK4819_WriteRegister(BK4819_REG_33, gBK4819_GpioOutState);
 }
 
+Filter BK4819_GetFilterFor(uint32_t f) {
+  return f < SETTINGS_GetFilterBound() ? FILTER_VHF : FILTER_UHF;
+}
+
 void BK4819_SelectFilter(uint32_t f) {
   // Log("BK -- SEL flt for %u", f);
-  Filter filter = f < SETTINGS_GetFilterBound() ? FILTER_VHF : FILTER_UHF;
+  Filter filter = BK4819_GetFilterFor(f);
 
   if (selectedFilter != filter) {
     selectedFilter = filter;
@@ -1067,14 +1104,7 @@ void BK4819_ToggleAFDAC(bool on) {
   BK4819_WriteRegister(BK4819_REG_30, Reg);
 }
 
-void BK4819_TuneTo(uint32_t f, bool precise) {
-  static uint32_t oldFreq;
-  if (oldFreq == f) { // TODO: maybe save current freq locally
-    return;
-  }
-  BK4819_SelectFilter(f);
-  BK4819_SetFrequency(f);
-  oldFreq = f;
+static void retune(bool precise) {
   uint16_t reg = BK4819_ReadRegister(BK4819_REG_30);
   if (precise) {
     BK4819_WriteRegister(BK4819_REG_30, 0x0200);
@@ -1084,6 +1114,132 @@ void BK4819_TuneTo(uint32_t f, bool precise) {
   BK4819_WriteRegister(BK4819_REG_30, reg);
 }
 
+void BK4819_TuneTo(uint32_t f, bool precise) {
+  if (oldFreq == f) { // TODO: maybe save current freq locally
+    return;
+  }
+  BK4819_TuneToEx(f, BK4819_GetFilterFor(f), precise);
+}
+
+// Filter is known in advance (scan plan)
+void BK4819_TuneToEx(uint32_t f, Filter filter, bool precise) {
+  if (oldFreq == f) {
+    return;
+  }
+  if (selectedFilter != filter) {
+    selectedFilter = filter;
+    BK4819_SelectFilterEx(filter);
+  }
+  BK4819_SetFrequency(f);
+  oldFreq = f;
+  if (recording) {
+    recording->precise = precise;
+  }
+  retune(precise);
+}
+
+// Start collecting writes into s. Driver caches are dropped so that every
+// setting is really written and lands in the snapshot.
+void BK4819_SnapshotRecord(BK4819_Snapshot *s) {
+  s->count = 0;
+  s->precise = false;
+  s->valid = true;
+  oldFreq = 0;
+  oldMod = 255;
+  selectedFilter = FILTER_OFF;
+  recording = s;
+}
+
+void BK4819_SnapshotStop(void) {
+  if (!recording) {
+    return;
+  }
+  recording->f = oldFreq;
+  recording->mod = oldMod;
+  recording->filter = selectedFilter;
+  lastSnapshot = recording->valid ? recording : NULL;
+  recording = NULL;
+}
+
+static bool snapshotFind(const BK4819_Snapshot *s, uint8_t hint, uint8_t reg,
+                         uint16_t *value) {
+  // same code path records registers in the same order, try hint first
+  if (hint < s->count && s->regs[hint].reg == reg) {
+    *value = s->regs[hint].value;
+    return true;
+  }
+  for (uint8_t i = 0; i < s->count; ++i) {
+    if (s->regs[i].reg == reg) {
+      *value = s->regs[i].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Writes registers of s differing from the last applied snapshot
+static uint8_t snapshotWrite(const BK4819_Snapshot *s, bool *needRetune) {
+  const BK4819_Snapshot *prev = lastSnapshot;
+  uint8_t written = 0;
+  for (uint8_t i = 0; i < s->count; ++i) {
+    const BK4819_RegWrite *w = &s->regs[i];
+    uint16_t v;
+    if (prev && snapshotFind(prev, i, w->reg, &v) && v == w->value) {
+      continue;
+    }
+    BK4819_WriteRegister(w->reg, w->value);
+    written++;
+    if (w->reg == BK4819_REG_38 || w->reg == BK4819_REG_39) {
+      *needRetune = true;
+    }
+  }
+  lastSnapshot = s;
+  oldMod = s->mod;
+  return written;
+}
+
+// Write only registers differing from the last applied snapshot,
+// returns count of written registers
+uint8_t BK4819_SnapshotApply(const BK4819_Snapshot *s) {
+  bool needRetune = false;
+
+  if (lastSnapshot == s) {
+    return 0;
+  }
+
+  applying = true;
+  if (selectedFilter != s->filter) {
+    selectedFilter = s->filter;
+    BK4819_SelectFilterEx(s->filter);
+  }
+  const uint8_t written = snapshotWrite(s, &needRetune);
+  if (needRetune) {
+    retune(s->precise);
+  }
+  applying = false;
+
+  oldFreq = s->f;
+  return written;
+}
+
+// Snapshot without frequency (scan plan profile) + tune to f. Tuning is done
+// while applying, so the chip still matches s and the next hop to another
+// profile writes only the difference.
+uint8_t BK4819_SnapshotApplyAt(const BK4819_Snapshot *s, uint32_t f,
+                               Filter filter, bool precise) {
+  bool needRetune = false;
+  uint8_t written = 0;
+
+  applying = true;
+  if (lastSnapshot != s) {
+    written = snapshotWrite(s, &needRetune);
+    oldFreq = 0; // новый профиль: перестраиваемся даже на ту же частоту
+  }
+  BK4819_TuneToEx(f, filter, precise);
+  applying = false;
+  return written;
+}
+
 void BK4819_SetToneFrequency(uint16_t f) {
   BK4819_WriteRegister(BK4819_REG_71, scale_freq(f));
 }
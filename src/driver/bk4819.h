@@ -94,6 +94,24 @@ typedef struct {
 typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 extern const Gain gainTable[32];
 
+#define BK4819_SNAPSHOT_MAX 24
+
+typedef struct {
+  uint8_t reg;
+  uint16_t value;
+} __attribute__((packed)) BK4819_RegWrite;
+
+// Final register values written while applying full VFO settings
+typedef struct {
+  BK4819_RegWrite regs[BK4819_SNAPSHOT_MAX];
+  uint32_t f;
+  uint8_t count;
+  ModulationType mod;
+  Filter filter;
+  bool precise;
+  bool valid;
+} BK4819_Snapshot;
+
 #define AUTO_GAIN_INDEX 20
 #define PLUS2_GAIN_INDEX 21
 #define PLUS10_GAIN_INDEX 23
@@ -107,6 +125,12 @@ void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data);
 void BK4819_WriteU8(uint8_t Data);
 void BK4819_WriteU16(uint16_t Data);
 
+void BK4819_SnapshotRecord(BK4819_Snapshot *s);
+void BK4819_SnapshotStop(void);
+uint8_t BK4819_SnapshotApply(const BK4819_Snapshot *s);
+uint8_t BK4819_SnapshotApplyAt(const BK4819_Snapshot *s, uint32_t f,
+                               Filter filter, bool precise);
+
 void BK4819_SetAGC(bool useDefault, uint8_t gainIndex);
 
 void BK4819_ToggleGpioOut(BK4819_GPIO_PIN_t Pin, bool bSet);
@@ -127,6 +151,7 @@ void BK4819_SetAF(BK4819_AF_Type_t AF);
 void BK4819_RX_TurnOn(void);
 void BK4819_SelectFilterEx(Filter filter);
 void BK4819_SelectFilter(uint32_t Frequency);
+Filter BK4819_GetFilterFor(uint32_t f);
 void BK4819_DisableScramble(void);
 void BK4819_EnableScramble(uint8_t Type);
 void BK4819_SetScrambler(uint8_t type);
@@ -205,6 +230,7 @@ void BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void BK4819_SetAFC(uint8_t level);
 uint8_t BK4819_GetAFC();
 void BK4819_TuneTo(uint32_t f, bool precise);
+void BK4819_TuneToEx(uint32_t f, Filter filter, bool precise);
 void BK4819_SetToneFrequency(uint16_t f);
 void BK4819_SetTone2Frequency(uint16_t f);
 void BK4819_SetModulation(ModulationType type);
@@ -2,6 +2,7 @@
 #include "../inc/dp32g030/gpio.h"
 #include "../misc.h"
 #include "../settings.h"
+#include "../scheduler.h"
 #include "../system.h"
 #include "audio.h"
 #include "eeprom.h"
@@ -22,6 +23,7 @@ static SsbMode currentSsbMode;
 SI47XX_MODE si4732mode = SI47XX_FM;
 uint16_t siCurrentFreq = 0;
 bool isSi4732On = false;
+static bool isPatched = false; // SSB патч в RAM чипа, живёт до power down
 
 static uint16_t fDiv() { return si4732mode == SI47XX_FM ? 1000 : 100; }
 
@@ -39,10 +41,14 @@ void SI47XX_WriteBuffer(uint8_t *buf, uint8_t size) {
   I2C_Stop();
 }
 
-bool SI47XX_IsSSB() {
-  return si4732mode == SI47XX_USB || si4732mode == SI47XX_LSB;
+static bool isSSBMode(SI47XX_MODE mode) {
+  return mode == SI47XX_USB || mode == SI47XX_LSB;
 }
 
+bool SI47XX_IsSSB() { return isSSBMode(si4732mode); }
+
+bool SI47XX_IsPatched() { return isPatched; }
+
 void waitToSend() {
   uint8_t tmp = 0;
   do {
@@ -52,30 +58,124 @@ void waitToSend() {
 }
 
 #include "../ui/graphics.h" // X_X
-void SI47XX_downloadPatch() {
-  // Log("DL patch");
+
+#define PATCH_CHUNK 8   // команда патча, столько принимает чип за раз
+#define PATCH_BLOCK 128 // чтение EEPROM: один адресный цикл на 16 команд
+#define PATCH_POLLS 255 // опросов CTS внутри одной транзакции
+
+static void drawPatchProgress(uint16_t done) {
   FillRect(0, LCD_YCENTER - 4, LCD_WIDTH, 9, C_FILL);
-  PrintMediumBoldEx(LCD_XCENTER, LCD_YCENTER + 3, POS_C, C_INVERT, "WAIT...");
+  PrintMediumBoldEx(LCD_XCENTER, LCD_YCENTER + 3, POS_C, C_INVERT,
+                    "SSB PATCH");
+  FillRect(0, LCD_YCENTER - 4, (uint32_t)LCD_WIDTH * done / PATCH_SIZE, 9,
+           C_INVERT);
   ST7565_Blit();
+}
+
+// Опрос CTS и запись куска одной транзакцией: повторный START вместо
+// STOP/START между чтением статуса и записью. Возвращает число повторов.
+static uint8_t writeWhenReady(const uint8_t *buf, uint8_t size) {
+  uint8_t polls = 0;
+  uint8_t status;
+  I2C_Start();
+  do {
+    if (polls) {
+      I2C_Start();
+    }
+    I2C_Write(SI47XX_I2C_ADDR + 1);
+    status = I2C_Read(true);
+  } while (!(status & STATUS_CTS) && ++polls < PATCH_POLLS);
+
+  if (!(status & STATUS_CTS)) {
+    // чип долго занят: отпускаем шину, чтобы не держать прерывания
+    I2C_Stop();
+    waitToSend();
+  }
+  I2C_Start();
+  I2C_Write(SI47XX_I2C_ADDR);
+  I2C_WriteBuffer(buf, size);
+  I2C_Stop();
+  return polls;
+}
+
+void SI47XX_downloadPatch() {
+  const uint32_t startTime = Now();
+  uint32_t polls = 0;
+  drawPatchProgress(0);
 
-  uint8_t buf[64]; // 64 is optimal, more has no sense
-  const uint16_t BUF_SIZE = ARRAY_SIZE(buf);
+  // EEPROM и SI на одной программной шине, поэтому перекрыть чтение с
+  // записью нельзя: читаем крупными блоками и гоним их без пауз
+  uint8_t buf[PATCH_BLOCK];
   const uint32_t PATCH_START = SETTINGS_GetEEPROMSize() - PATCH_SIZE;
 
-  for (uint16_t offset = 0; offset < PATCH_SIZE; offset += BUF_SIZE) {
-    const uint32_t rest = PATCH_SIZE - offset;
-    const uint32_t eepromN = rest > BUF_SIZE ? BUF_SIZE : rest;
+  for (uint16_t offset = 0; offset < PATCH_SIZE; offset += PATCH_BLOCK) {
+    const uint16_t rest = PATCH_SIZE - offset;
+    const uint16_t eepromN = rest > PATCH_BLOCK ? PATCH_BLOCK : rest;
     EEPROM_ReadBuffer(PATCH_START + offset, buf, eepromN);
 
-    for (uint16_t i = 0; i < eepromN; i += 8) {
-      waitToSend();
-      SI47XX_WriteBuffer(buf + i, 8);
+    for (uint16_t i = 0; i < eepromN; i += PATCH_CHUNK) {
+      polls += writeWhenReady(buf + i, PATCH_CHUNK);
+    }
+
+    if ((offset & 1023) == 0) {
+      drawPatchProgress(offset + eepromN);
     }
   }
-  // Log("DL patch OK");
+  drawPatchProgress(PATCH_SIZE);
+  Log("SI patch %u B: %ums, CTS retries %u", PATCH_SIZE, Now() - startTime,
+      polls);
+}
+
+// Теневая копия записанных свойств: повторная запись того же значения
+// пропускается. После POWER_UP чип возвращается к умолчаниям, копия
+// сбрасывается.
+#define PROP_SHADOW_SIZE 16
+
+typedef struct {
+  uint16_t prop;
+  uint16_t value;
+} PropShadow;
+
+static PropShadow propShadow[PROP_SHADOW_SIZE];
+static uint8_t propShadowCount;
+static uint8_t propShadowNext;
+static int32_t agcShadow = -1;
+
+static void shadowReset() {
+  propShadowCount = 0;
+  propShadowNext = 0;
+  agcShadow = -1;
+}
+
+static PropShadow *shadowFind(uint16_t prop) {
+  for (uint8_t i = 0; i < propShadowCount; ++i) {
+    if (propShadow[i].prop == prop) {
+      return &propShadow[i];
+    }
+  }
+  return NULL;
+}
+
+static void shadowStore(uint16_t prop, uint16_t value) {
+  PropShadow *p = shadowFind(prop);
+  if (!p) {
+    p = &propShadow[propShadowNext];
+    propShadowNext = (propShadowNext + 1) % PROP_SHADOW_SIZE;
+    if (propShadowCount < PROP_SHADOW_SIZE) {
+      propShadowCount++;
+    }
+    p->prop = prop;
+  }
+  p->value = value;
 }
 
 void SI47XX_SetProperty(uint16_t prop, uint16_t value) {
+  if (isSi4732On) {
+    const PropShadow *p = shadowFind(prop);
+    if (p && p->value == value) {
+      return;
+    }
+  }
   waitToSend();
   uint8_t tmp[6] = {
       CMD_SET_PROPERTY, 0,           //
@@ -83,7 +183,10 @@ void SI47XX_SetProperty(uint16_t prop, uint16_t value) {
       value >> 8,       value & 0xff //
   };
   SI47XX_WriteBuffer(tmp, 6);
-  SYS_DelayMs(8); // irrespective of CTS coming up earlier than that
+  waitToSend(); // CTS = свойство применено, фиксированная пауза не нужна
+  if (isSi4732On) {
+    shadowStore(prop, value);
+  }
 }
 
 /* uint16_t SI47XX_GetProperty(uint16_t prop, bool *valid) {
@@ -151,10 +254,18 @@ void SI47XX_SetAutomaticGainControl(uint8_t AGCDIS, uint8_t AGCIDX) {
   agc.arg.AGCDIS = AGCDIS;
   agc.arg.AGCIDX = AGCIDX;
 
+  const int32_t agcValue = (agc.raw[0] << 8) | agc.raw[1];
+  if (isSi4732On && agcShadow == agcValue) {
+    return;
+  }
+
   waitToSend();
 
   uint8_t cmd2[] = {cmd, agc.raw[0], agc.raw[1]};
   SI47XX_WriteBuffer(cmd2, 3);
+  if (isSi4732On) {
+    agcShadow = agcValue;
+  }
 }
 
 void SI47XX_PowerUp() {
@@ -165,6 +276,7 @@ void SI47XX_PowerUp() {
   }
   waitToSend();
   SI47XX_WriteBuffer(cmd, 3);
+  shadowReset();
   SYS_DelayMs(500);
 
   isSi4732On = true;
@@ -198,15 +310,20 @@ void SI47XX_SsbSetup(SI47XX_SsbFilterBW AUDIOBW, uint8_t SBCUTFLT,
 }
 
 void SI47XX_PatchPowerUp() {
+  if (!SI47XX_IsSSB()) {
+    si4732mode = SI47XX_USB;
+  }
   RST_HIGH;
   uint8_t cmd[3] = {CMD_POWER_UP, 0b00110001, OUT_ANALOG};
   waitToSend();
   SI47XX_WriteBuffer(cmd, 3);
+  shadowReset();
   SYS_DelayMs(60);
 
   isSi4732On = true;
 
   SI47XX_downloadPatch();
+  isPatched = true;
 
   SI47XX_SsbSetup(2, 1, 0, 1, 0, 1);
   setAvcAmMaxGain(42);
@@ -217,9 +334,6 @@ void SI47XX_PatchPowerUp() {
   SI47XX_SetFreq(siCurrentFreq);
   SI47XX_SetProperty(PROP_SSB_SOFT_MUTE_MAX_ATTENUATION, 0);
   SI47XX_SetProperty(PROP_AM_AUTOMATIC_VOLUME_CONTROL_MAX_GAIN, 0x7800);
-
-  si4732mode = SI47XX_USB; // FIXME: modulation must be set before power on to
-                           // prevent repowering
 }
 
 void SI47XX_SetSsbBandwidth(SI47XX_SsbFilterBW bw) {
@@ -267,22 +381,48 @@ void SI47XX_PowerDown() {
   SYSTICK_Delay250ns(10);
   RST_LOW;
   isSi4732On = false;
+  isPatched = false;
+  shadowReset();
   siCurrentFreq = 0;
 }
 
+// Патч нужен только SSB. LSB/USB внутри патча переключаются перестройкой,
+// в AM/FM чип надо перезапустить с родной прошивкой.
 void SI47XX_SwitchMode(SI47XX_MODE mode) {
-  if (si4732mode != mode) {
-    bool wasSSB = SI47XX_IsSSB();
-    si4732mode = mode;
-    if (mode == SI47XX_USB || mode == SI47XX_LSB) {
-      if (!wasSSB) {
-        SI47XX_PowerDown();
-        SI47XX_PatchPowerUp();
-      }
-    } else {
-      SI47XX_PowerDown();
-      SI47XX_PowerUp();
-    }
+  if (si4732mode == mode) {
+    return;
+  }
+  si4732mode = mode;
+  if (!isSi4732On) {
+    return; // включится сразу в нужном режиме, см. SI47XX_Resume
+  }
+  if (isSSBMode(mode) && isPatched) {
+    const uint16_t f = siCurrentFreq;
+    siCurrentFreq = 0;
+    SI47XX_SetFreq(f); // боковая полоса задаётся в AM_TUNE_FREQ
+    return;
+  }
+  SI47XX_PowerDown();
+  if (isSSBMode(mode)) {
+    SI47XX_PatchPowerUp();
+  } else {
+    SI47XX_PowerUp();
+  }
+}
+
+// Включение на приём: если чип уже в нужном состоянии, только звук
+void SI47XX_Resume(SI47XX_MODE mode) {
+  if (isSi4732On) {
+    Log("SI resume, patched=%u", isPatched);
+    SI47XX_SwitchMode(mode);
+    SI47XX_SetVolume(63);
+    return;
+  }
+  si4732mode = mode;
+  if (isSSBMode(mode)) {
+    SI47XX_PatchPowerUp();
+  } else {
+    SI47XX_PowerUp();
   }
 }
 
@@ -372,6 +512,53 @@ void SI47XX_SetSeekAmRssiThreshold(uint16_t value) {
   SI47XX_SetProperty(PROP_AM_SEEK_TUNE_RSSI_THRESHOLD, value);
 }
 
+void SI47XX_SetSeekFmSnrThreshold(uint16_t value) {
+  SI47XX_SetProperty(PROP_FM_SEEK_TUNE_SNR_THRESHOLD, value);
+}
+
+void SI47XX_SetSeekAmSnrThreshold(uint16_t value) {
+  SI47XX_SetProperty(PROP_AM_SEEK_TUNE_SNR_THRESHOLD, value);
+}
+
+// Неблокирующая проверка окончания seek/tune по STCINT в байте статуса.
+// Когда готово, читает TUNE_STATUS и сбрасывает STCINT.
+bool SI47XX_SeekPoll(SI47XX_SeekResult *r) {
+  uint8_t status = 0;
+  SI47XX_ReadBuffer(&status, 1);
+  if (!(status & STATUS_CTS) || !(status & STATUS_STCINT)) {
+    return false;
+  }
+
+  uint8_t cmd[2] = {CMD_FM_TUNE_STATUS, TUNE_STATUS_ARG1_CLEAR_INT};
+  if (si4732mode != SI47XX_FM) {
+    cmd[0] = CMD_AM_TUNE_STATUS;
+  }
+  uint8_t response[6] = {0};
+  SI47XX_WriteBuffer(cmd, 2);
+  waitToSend();
+  SI47XX_ReadBuffer(response, 6);
+
+  siCurrentFreq = (response[2] << 8) | response[3];
+  r->f = siCurrentFreq * fDiv();
+  r->valid = response[1] & STATUS_VALID;
+  r->bandLimit = response[1] & STATUS_BLTF;
+  r->rssi = response[4];
+  r->snr = response[5];
+  return true;
+}
+
+// Перестройка с ожиданием STCINT: после неё можно запускать seek, не
+// путая его окончание с окончанием перестройки
+void SI47XX_TuneSync(uint16_t freq) {
+  SI47xx_GetStatus(1, 0); // сброс оставшегося STCINT
+  siCurrentFreq = 0;
+  SI47XX_SetFreq(freq);
+  SI47XX_SeekResult r;
+  for (uint8_t i = 0; i < 100 && !SI47XX_SeekPoll(&r); ++i) {
+    SYS_DelayMs(1);
+  }
+}
+
 void SI47XX_SetBFO(int16_t bfo) { SI47XX_SetProperty(PROP_SSB_BFO, bfo); }
 
 void SI47XX_TuneTo(uint32_t f) {
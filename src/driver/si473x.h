@@ -567,6 +567,14 @@ typedef union {
   uint8_t raw[2];
 } SI47XX_BW_Config; // AM_CHANNEL_FILTER
 
+typedef struct {
+  uint32_t f;
+  uint8_t rssi; // dBuV
+  uint8_t snr;  // dB
+  bool valid : 1;
+  bool bandLimit : 1;
+} SI47XX_SeekResult;
+
 void SI47XX_PowerUp();
 void SI47XX_PatchPowerUp();
 void SI47XX_PowerDown();
@@ -574,6 +582,8 @@ void SI47XX_SetFreq(uint16_t freq);
 void SI47XX_ReadRDS(uint8_t buf[13]);
 void SI47XX_SwitchMode(SI47XX_MODE mode);
 bool SI47XX_IsSSB();
+bool SI47XX_IsPatched();
+void SI47XX_Resume(SI47XX_MODE mode);
 void RSQ_GET();
 void SI47XX_SetAutomaticGainControl(uint8_t AGCDIS, uint8_t AGCIDX);
 void SI47XX_Seek(bool up, bool wrap);
@@ -586,6 +596,10 @@ void SI47XX_SetSeekFmSpacing(uint32_t spacing);
 void SI47XX_SetSeekAmSpacing(uint32_t spacing);
 void SI47XX_SetSeekFmRssiThreshold(uint16_t value);
 void SI47XX_SetSeekAmRssiThreshold(uint16_t value);
+void SI47XX_SetSeekFmSnrThreshold(uint16_t value);
+void SI47XX_SetSeekAmSnrThreshold(uint16_t value);
+bool SI47XX_SeekPoll(SI47XX_SeekResult *r);
+void SI47XX_TuneSync(uint16_t freq);
 void SI47XX_SetBFO(int16_t bfo);
 void SI47XX_SetSsbCapacitor(uint16_t v);
 void SI47XX_TuneTo(uint32_t f);
@@ -29,3 +29,8 @@ void SYSTICK_DelayUs(const uint32_t Delay) {
 void SYSTICK_Delay250ns(const uint32_t Delay) {
   SYSTICK_DelayTicks(Delay * TICK_MULTIPLIER / 4);
 }
+
+// Прошедшая часть текущего миллисекундного тика, мкс
+uint32_t SYSTICK_GetTickUs(void) {
+  return (SysTick->LOAD - SysTick->VAL) / TICK_MULTIPLIER;
+}
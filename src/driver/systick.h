@@ -23,5 +23,6 @@ void SYSTICK_Init(void);
 void SYSTICK_DelayTicks(const uint32_t ticks);
 void SYSTICK_DelayUs(const uint32_t Delay);
 void SYSTICK_Delay250ns(const uint32_t Delay);
+uint32_t SYSTICK_GetTickUs(void);
 
 #endif
@@ -4,8 +4,11 @@
 #include "../radio.h"
 #include "channels.h"
 #include "measurements.h"
+#include "powcalib.h"
 #include <stdint.h>
 
+#define BAND_CACHE_SIZE 6
+
 // NOTE
 // for SCAN use cached band by index
 // for DISPLAY use bands in memory to select it by frequency faster
@@ -34,99 +37,58 @@ Band defaultBand = {
     .allowTx = false,
 };
 
-static DBand allBands[BANDS_COUNT_MAX];
+static DBand allBands[BANDS_COUNT_MAX]; // sorted by start at load
+static uint32_t allBandsMaxEnd[BANDS_COUNT_MAX]; // max end of [0..i]
 static int16_t allBandIndex; // -1 if default is current
 static uint8_t allBandsSize = 0;
 
-static uint8_t scanlistBandIndex;
+static int16_t scanlistBand = -1; // MR number of band in scanlist
 
-static Band rangesStack[RANGES_STACK_SIZE] = {0};
-static int8_t rangesStackIndex = -1;
+// LRU of decoded band records by MR, dropped on any channel save
+typedef struct {
+  Band band;
+  uint32_t lastUse;
+  int16_t mr;
+  bool valid;
+} CachedBand;
 
-static const PowerCalibration DEFAULT_POWER_CALIB = {
-    43, 68, 140}; // Standard UV-K6 Power Calibration
-// static const PowerCalibration DEFAULT_POWER_CALIB = {41, 65, 140};  //
-// Modified UV-K6 Power Calibrations BFU550 A + Seperated Coils static const
-// PowerCalibration DEFAULT_POWER_CALIB = {40, 65, 140};  // reborn orginal
-
-PCal POWER_CALIBRATIONS[] = {
-    /*
-     (PCal){.s = 14400000, .e = 14799999, .c = {38, 63, 138}},         // reborn
-     original (PCal){.s = 14800000, .e = 17399999, .c = {37, 60, 130}},
-     (PCal){.s = 17400000, .e = 24499999, .c = {46, 55, 140}},
-     (PCal){.s = 24500000, .e = 26999999, .c = {58, 80, 140}},
-     (PCal){.s = 27000000, .e = 42999999, .c = {77, 95, 140}},
-     (PCal){.s = 43000000, .e = 46999999, .c = DEFAULT_POWER_CALIB},
-     (PCal){.s = 47000000, .e = 61999999, .c = {50, 100, 140}},
-
-   */
-
-    // Standard UV-K6 Power Calibration
-
-    (PCal){.s = 13500000, .e = 16499999, .c = {38, 65, 140}},
-    (PCal){.s = 16500000, .e = 20499999, .c = {36, 52, 140}},
-    (PCal){.s = 20500000, .e = 21499999, .c = {41, 64, 135}},
-    (PCal){.s = 21500000, .e = 21999999, .c = {44, 46, 50}},
-    //(PCal){.s = 22000000, .e = 23999999, .c = {0, 0, 0}},     // no power
-    // output power
-    (PCal){.s = 24000000, .e = 26499999, .c = {62, 82, 130}},
-    (PCal){.s = 26500000, .e = 26999999, .c = {65, 92, 140}},
-    (PCal){.s = 27000000, .e = 27499999, .c = {73, 103, 140}},
-    (PCal){.s = 27500000, .e = 28499999, .c = {81, 107, 140}},
-    (PCal){.s = 28500000, .e = 29499999, .c = {57, 94, 140}},
-    (PCal){.s = 29500000, .e = 30499999, .c = {74, 104, 140}},
-    (PCal){.s = 30500000, .e = 33499999, .c = {81, 107, 140}},
-    (PCal){.s = 33500000, .e = 34499999, .c = {63, 98, 140}},
-    (PCal){.s = 34500000, .e = 35499999, .c = {52, 89, 140}},
-    (PCal){.s = 35500000, .e = 36499999, .c = {46, 74, 140}},
-    //(PCal){.s = 36500000, .e = 46999999, .c = DEFAULT_POWER_CALIB},     // no
-    // need to add this line as it will drop to the default if not found ?
-    (PCal){.s = 47000000, .e = 61999999, .c = {46, 77, 140}},
-
-    /*
-
-
-       // Modified UV-K6 Power Calibrations BFU550 A + Seperated Coils
-
-      //(PCal){.s = 14400000, .e = 19499999, .c = DEFAULT_POWER_CALIB},
-        (PCal){.s = 19500000, .e = 20499999, .c = {49, 78, 140}},
-        (PCal){.s = 20500000, .e = 21499999, .c = {63, 96, 140}},
-        (PCal){.s = 21500000, .e = 21999999, .c = {82, 108, 140}},
-        (PCal){.s = 22000000, .e = 22499999, .c = {96, 115, 140}},
-        (PCal){.s = 22500000, .e = 23499999, .c = {93, 106, 120}},
-      //(PCal){.s = 23500000, .e = 23999999, .c = {0, 0, 0}},       // no power
-      output power (PCal){.s = 24000000, .e = 25499999, .c = {50, 78, 135}},
-        (PCal){.s = 25500000, .e = 26999999, .c = {48, 62, 108}},
-        (PCal){.s = 27000000, .e = 27499999, .c = {50, 73, 118}},
-        (PCal){.s = 27500000, .e = 28499999, .c = {59, 85, 130}},
-        (PCal){.s = 28500000, .e = 29499999, .c = {51, 90, 140}},
-        (PCal){.s = 29500000, .e = 30499999, .c = {74, 106, 140}},
-        (PCal){.s = 30500000, .e = 33499999, .c = {85, 109, 140}},
-        (PCal){.s = 33500000, .e = 34499999, .c = {79, 106, 140}},
-        (PCal){.s = 34500000, .e = 35499999, .c = {65, 98, 140}},
-        (PCal){.s = 35500000, .e = 38499999, .c = {48, 85, 140}},
-        (PCal){.s = 38500000, .e = 39499999, .c = {44, 68, 140}},
-        (PCal){.s = 39500000, .e = 42499999, .c = {38, 59, 140}},
-      //(PCal){.s = 42500000, .e = 46900000, .c = DEFAULT_POWER_CALIB},
-        (PCal){.s = 47000000, .e = 61999999, .c = {46, 75, 140}},
-
-    */
+static CachedBand bandCache[BAND_CACHE_SIZE];
+static uint32_t bandCacheTick;
+static uint16_t bandCacheRevision;
 
-};
+static Band rangesStack[RANGES_STACK_SIZE] = {0};
+static int8_t rangesStackIndex = -1;
 
+// Best band is the narrowest one containing f (lower MR on tie).
+// Binary search for the last band starting at or below f, then walk back
+// while the running max end still reaches f.
 static int16_t bandIndexByFreq(uint32_t f, bool preciseStep) {
+  int16_t lo = 0;
+  int16_t hi = allBandsSize - 1;
+  int16_t last = -1;
+  while (lo <= hi) {
+    const int16_t mid = (lo + hi) / 2;
+    if (allBands[mid].s <= f) {
+      last = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
   int16_t newBandIndex = -1;
   uint32_t smallestDiff = UINT32_MAX;
-  for (uint8_t i = 0; i < allBandsSize; ++i) {
+  for (int16_t i = last; i >= 0 && allBandsMaxEnd[i] >= f; --i) {
     DBand *b = &allBands[i];
-    if (f < b->s || f > b->e) {
+    if (f > b->e) {
       continue;
     }
-    if (preciseStep & (f % StepFrequencyTable[b->step])) {
+    if (preciseStep && (f % StepFrequencyTable[b->step])) {
       continue;
     }
-    uint32_t diff = DeltaF(b->s, f) + DeltaF(b->e, f);
-    if (diff < smallestDiff) {
+    const uint32_t diff = b->e - b->s;
+    if (diff < smallestDiff ||
+        (diff == smallestDiff && b->mr < allBands[newBandIndex].mr)) {
       smallestDiff = diff;
       newBandIndex = i;
     }
@@ -142,19 +104,61 @@ void BANDS_Load(void) {
 
     CH ch;
     CHANNELS_Load(chNum, &ch);
-    allBands[allBandsSize] = (DBand){
+    DBand band = {
         .mr = chNum,
         .s = ch.rxF,
         .e = ch.txF,
         .step = ch.step,
     };
 
+    // insertion by start keeps the array sorted
+    int16_t i = allBandsSize;
+    while (i > 0 && allBands[i - 1].s > band.s) {
+      allBands[i] = allBands[i - 1];
+      i--;
+    }
+    allBands[i] = band;
+
     allBandsSize++;
 
     if (allBandsSize >= BANDS_COUNT_MAX) {
       break;
     }
   }
+
+  for (uint8_t i = 0; i < allBandsSize; ++i) {
+    allBandsMaxEnd[i] = i && allBandsMaxEnd[i - 1] > allBands[i].e
+                            ? allBandsMaxEnd[i - 1]
+                            : allBands[i].e;
+  }
+}
+
+static void loadBand(int16_t mr, Band *b) {
+  if (bandCacheRevision != CHANNELS_GetRevision()) {
+    bandCacheRevision = CHANNELS_GetRevision();
+    for (uint8_t i = 0; i < BAND_CACHE_SIZE; ++i) {
+      bandCache[i].valid = false;
+    }
+  }
+
+  CachedBand *lru = &bandCache[0];
+  for (uint8_t i = 0; i < BAND_CACHE_SIZE; ++i) {
+    CachedBand *c = &bandCache[i];
+    if (c->valid && c->mr == mr) {
+      c->lastUse = ++bandCacheTick;
+      *b = c->band;
+      return;
+    }
+    if (!c->valid || (lru->valid && c->lastUse < lru->lastUse)) {
+      lru = c;
+    }
+  }
+
+  CHANNELS_Load(mr, &lru->band);
+  lru->mr = mr;
+  lru->valid = true;
+  lru->lastUse = ++bandCacheTick;
+  *b = lru->band;
 }
 
 bool BANDS_InRange(const uint32_t f, const Band p) {
@@ -173,15 +177,12 @@ void BANDS_SetRadioParamsFromCurrentBand() {
 
 // Set gCurrentBand, sets internal cursor in SL
 void BANDS_Select(int16_t num, bool copyToVfo) {
-  CHANNELS_Load(num, &gCurrentBand);
+  loadBand(num, &gCurrentBand);
   Log("Select Band %s", gCurrentBand.name);
-  for (int16_t i = 0; i < gScanlistSize; ++i) {
-    if (gScanlist[i] == num) {
-      scanlistBandIndex = i;
-      allBandIndex = bandIndexByFreq(gCurrentBand.rxF, true);
-      Log("SL band index %u", i);
-      break;
-    }
+  if (CHANNELS_InScanlist(num)) {
+    scanlistBand = num;
+    allBandIndex = bandIndexByFreq(gCurrentBand.rxF, true);
+    Log("SL band %u", num);
   }
   // radio.allowTx = gCurrentBand.allowTx;
   if (copyToVfo) {
@@ -192,8 +193,8 @@ void BANDS_Select(int16_t num, bool copyToVfo) {
 // Used in vfo1 to select first band from scanlist
 void BANDS_SelectScan(int8_t i) {
   if (gScanlistSize) {
-    scanlistBandIndex = i;
-    // RADIO_TuneToBand(gScanlist[i]);
+    scanlistBand = CHANNELS_ScanlistAt(i);
+    // RADIO_TuneToBand(scanlistBand);
   }
 }
 
@@ -201,13 +202,15 @@ Band BANDS_ByFrequency(uint32_t f) {
   int16_t index = bandIndexByFreq(f, false);
   if (index >= 0) {
     Band b;
-    CHANNELS_Load(allBands[index].mr, &b);
+    loadBand(allBands[index].mr, &b);
     return b;
   }
   return defaultBand;
 }
 
-uint8_t BANDS_GetScanlistIndex() { return scanlistBandIndex; }
+uint8_t BANDS_GetScanlistIndex() {
+  return CHANNELS_ScanlistIndexOf(scanlistBand);
+}
 
 /**
  * Select band, return if changed
@@ -231,10 +234,10 @@ bool BANDS_SelectBandRelativeByScanlist(bool next) {
   if (gScanlistSize == 0) {
     return false;
   }
-  uint8_t oldScanlistBandIndex = scanlistBandIndex;
-  scanlistBandIndex = IncDecU(scanlistBandIndex, 0, gScanlistSize, next);
-  BANDS_Select(gScanlist[scanlistBandIndex], true);
-  return oldScanlistBandIndex != scanlistBandIndex;
+  int16_t oldScanlistBand = scanlistBand;
+  scanlistBand = CHANNELS_ScanlistStep(scanlistBand, next);
+  BANDS_Select(scanlistBand, true);
+  return oldScanlistBand != scanlistBand;
 }
 
 void BANDS_SaveCurrent(void) {
@@ -250,14 +253,7 @@ PowerCalibration BANDS_GetPowerCalib(uint32_t f) {
       b.misc.powCalib.e > 0) { // not TYPE_BAND_DETACHED
     return b.misc.powCalib;
   }
-  for (uint8_t ci = 0; ci < ARRAY_SIZE(POWER_CALIBRATIONS); ++ci) {
-    PCal cal = POWER_CALIBRATIONS[ci];
-    if (cal.s <= f && f <= cal.e) {
-      return cal.c;
-      break;
-    }
-  }
-  return DEFAULT_POWER_CALIB;
+  return POWCALIB_Interpolate(f);
 }
 
 void BANDS_RangeClear() { rangesStackIndex = -1; }
@@ -19,12 +19,6 @@ typedef struct {
   Step step; // needed to select band by freq
 } DBand;
 
-typedef struct {
-  uint32_t s;
-  uint32_t e;
-  PowerCalibration c;
-} PCal;
-
 void BANDS_Load();
 
 PowerCalibration BANDS_GetPowerCalib(uint32_t f);
@@ -9,7 +9,7 @@
 #include <string.h>
 
 uint16_t gScanlistSize = 0;
-uint16_t gScanlist[SCANLIST_MAX] = {0};
+uint32_t gScanlist[SCANLIST_WORDS] = {0};
 CHType gScanlistType = TYPE_CH;
 const char *CH_TYPE_NAMES[6] = {"EMPTY", "CH",     "BAND",
                                 "VFO",   "FOLDER", "MELODY"};
@@ -17,6 +17,8 @@ const char *TX_POWER_NAMES[4] = {"ULow", "Low", "Mid", "High"};
 const char *TX_OFFSET_NAMES[3] = {"None", "+", "-"};
 const char *TX_CODE_TYPES[4] = {"None", "CT", "DCS", "-DCS"};
 
+static uint16_t revision; // changes on any channel save
+
 static uint32_t getChannelsEnd() {
   uint32_t eepromSize = SETTINGS_GetEEPROMSize();
   uint32_t minSizeWithPatch = CHANNELS_OFFSET + CH_SIZE + PATCH_SIZE;
@@ -48,9 +50,12 @@ void CHANNELS_Save(int16_t num, CH *p) {
     Log(">> W CH%u OFS=%u '%s': f=%u, radio=%u", num, GetChannelOffset(num),
         p->name, p->rxF, p->radio);
     EEPROM_WriteBuffer(GetChannelOffset(num), p, CH_SIZE);
+    revision++;
   }
 }
 
+uint16_t CHANNELS_GetRevision() { return revision; }
+
 void CHANNELS_Delete(int16_t num) {
   CH _ch;
   memset(&_ch, 0, sizeof(_ch));
@@ -69,30 +74,114 @@ uint16_t CHANNELS_Scanlists(int16_t num) {
   EEPROM_ReadBuffer(GetChannelOffset(num) + offsetof(CH, scanlists), &sl, 2);
   return sl;
 }
-static int16_t chScanlistIndex = 0;
+
+// Scanlist is a bitmap: bit N set -> MR N is in scanlist.
+// 128 B instead of 2 KB, membership is O(1), iteration skips empty words.
+
+bool CHANNELS_InScanlist(int16_t num) {
+  if (num < 0 || num >= SCANLIST_MAX) {
+    return false;
+  }
+  return (gScanlist[num >> 5] >> (num & 31)) & 1;
+}
+
+static int16_t nextSetBit(int16_t from) {
+  if (from >= SCANLIST_MAX) {
+    return -1;
+  }
+  uint16_t w = from >> 5;
+  uint32_t bits = gScanlist[w] & (UINT32_MAX << (from & 31));
+  for (;;) {
+    if (bits) {
+      return (w << 5) + __builtin_ctz(bits);
+    }
+    if (++w >= SCANLIST_WORDS) {
+      return -1;
+    }
+    bits = gScanlist[w];
+  }
+}
+
+static int16_t prevSetBit(int16_t from) {
+  if (from < 0) {
+    return -1;
+  }
+  int16_t w = from >> 5;
+  uint32_t bits = gScanlist[w] & (UINT32_MAX >> (31 - (from & 31)));
+  for (;;) {
+    if (bits) {
+      return (w << 5) + 31 - __builtin_clz(bits);
+    }
+    if (--w < 0) {
+      return -1;
+    }
+    bits = gScanlist[w];
+  }
+}
+
+// Next/prev MR in scanlist with wrap, -1 if scanlist is empty
+int16_t CHANNELS_ScanlistStep(int16_t num, bool next) {
+  int16_t r;
+  if (next) {
+    r = nextSetBit(num + 1);
+    return r >= 0 ? r : nextSetBit(0);
+  }
+  r = prevSetBit(num - 1);
+  return r >= 0 ? r : prevSetBit(SCANLIST_MAX - 1);
+}
+
+// MR number of index-th scanlist entry
+int16_t CHANNELS_ScanlistAt(uint16_t index) {
+  for (uint16_t w = 0; w < SCANLIST_WORDS; ++w) {
+    uint32_t bits = gScanlist[w];
+    uint8_t cnt = __builtin_popcount(bits);
+    if (index >= cnt) {
+      index -= cnt;
+      continue;
+    }
+    while (index--) {
+      bits &= bits - 1;
+    }
+    return (w << 5) + __builtin_ctz(bits);
+  }
+  return -1;
+}
+
+// Position of MR in scanlist (count of set bits below it)
+uint16_t CHANNELS_ScanlistIndexOf(int16_t num) {
+  if (num <= 0) {
+    return 0;
+  }
+  if (num >= SCANLIST_MAX) {
+    return gScanlistSize;
+  }
+  uint16_t index = 0;
+  uint16_t w = num >> 5;
+  for (uint16_t i = 0; i < w; ++i) {
+    index += __builtin_popcount(gScanlist[i]);
+  }
+  return index + __builtin_popcount(gScanlist[w] & ((1UL << (num & 31)) - 1));
+}
+
+static int16_t chScanlistCurrent = -1;
 
 int16_t CHANNELS_GetCurrentScanlistCH() {
   if (gScanlistSize) {
-    return gScanlist[chScanlistIndex];
+    return chScanlistCurrent;
   }
   return -1;
 }
 
 void CHANNELS_Next(bool next) {
   if (gScanlistSize) {
-    chScanlistIndex = IncDecI(chScanlistIndex, 0, gScanlistSize, next);
+    chScanlistCurrent = CHANNELS_ScanlistStep(chScanlistCurrent, next);
     // CHANNELS_LoadCurrentScanlistCH();
   }
 }
 
 void CHANNELS_SetScanlistIndexFromRadio() {
-  /* if (RADIO_IsChMode() && gScanlistSize) {
-    for (uint16_t i = 0; i < gScanlistSize; ++i) {
-      if (gScanlist[i] == radio.channel) {
-        chScanlistIndex = i;
-        break;
-      }
-    }
+  /* if (RADIO_IsChMode() && CHANNELS_InScanlist(radio.channel)) {
+    chScanlistCurrent = radio.channel;
   } */
 }
 
@@ -110,9 +199,15 @@ void CHANNELS_LoadScanlist(CHTypeFilter typeFilter, uint16_t scanlistMask) {
     gSettings.currentScanlist = scanlistMask;
     SETTINGS_Save();
   }
-  gScanlistSize = 0;
+  memset(gScanlist, 0, sizeof(gScanlist));
   for (uint16_t i = 0; i < CHANNELS_GetCountMax(); ++i) {
-    CHMeta meta = CHANNELS_GetMeta(i);
+    // meta + scanlists are adjacent, read them at once
+    struct {
+      CHMeta meta;
+      uint16_t scanlists;
+    } __attribute__((packed)) head;
+    EEPROM_ReadBuffer(GetChannelOffset(i), &head, sizeof(head));
+    CHMeta meta = head.meta;
     bool isSaveFilter = typeFilter == TYPE_FILTER_BAND_SAVE ||
                         typeFilter == TYPE_FILTER_CH_SAVE;
     bool isEmptyChannelToSave = meta.type == TYPE_EMPTY && isSaveFilter;
@@ -124,16 +219,19 @@ void CHANNELS_LoadScanlist(CHTypeFilter typeFilter, uint16_t scanlistMask) {
     }
 
     bool isOurScanlist = (isOurType && scanlistMask == SCANLIST_ALL) ||
-                         (CHANNELS_Scanlists(i) & scanlistMask) ||
+                         (head.scanlists & scanlistMask) ||
                          isEmptyChannelToSave;
     if (isOurScanlist) {
-      gScanlist[gScanlistSize] = i;
-      gScanlistSize++;
+      gScanlist[i >> 5] |= 1UL << (i & 31);
       // Log("Load CH %u in SL", i);
     }
   }
+  gScanlistSize = 0;
+  for (uint16_t w = 0; w < SCANLIST_WORDS; ++w) {
+    gScanlistSize += __builtin_popcount(gScanlist[w]);
+  }
   if (typeFilter == TYPE_FILTER_CH || typeFilter == TYPE_FILTER_CH_SAVE) {
-    chScanlistIndex = 0;
+    chScanlistCurrent = nextSetBit(0);
     CHANNELS_SetScanlistIndexFromRadio();
   }
   Log("SL sz: %u", gScanlistSize);
@@ -154,6 +252,34 @@ void CHANNELS_LoadBlacklistToLoot() {
   }
 }
 
+// Channels with meta.priority are checked by scanners as priority
+uint8_t CHANNELS_LoadPriority(uint32_t *fs, uint8_t max) {
+  uint8_t n = 0;
+  for (int16_t i = 0; i < CHANNELS_GetCountMax() && n < max; ++i) {
+    const CHMeta meta = CHANNELS_GetMeta(i);
+    if (meta.type == TYPE_CH && meta.priority) {
+      CH ch;
+      CHANNELS_Load(i, &ch);
+      fs[n++] = ch.rxF;
+    }
+  }
+  return n;
+}
+
+// Priority channel with this RX frequency, -1 if none
+int16_t CHANNELS_FindPriority(uint32_t f, CH *p) {
+  for (int16_t i = 0; i < CHANNELS_GetCountMax(); ++i) {
+    const CHMeta meta = CHANNELS_GetMeta(i);
+    if (meta.type == TYPE_CH && meta.priority) {
+      CHANNELS_Load(i, p);
+      if (p->rxF == f) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
 uint16_t CHANNELS_GetStepSize(CH *p) { return StepFrequencyTable[p->step]; }
 
 uint32_t CHANNELS_GetSteps(CH *p) {
@@ -2,6 +2,7 @@
 #define CHANNELS_H
 
 #define SCANLIST_MAX 1024
+#define SCANLIST_WORDS (SCANLIST_MAX / 32)
 
 #include "../driver/bk4819.h"
 #include "../driver/keyboard.h"
@@ -95,6 +96,7 @@ typedef enum {
 typedef struct {
   CHType type : 3;
   bool readonly : 1;
+  bool priority : 1; // сканеры проверяют канал как приоритетный
 } CHMeta;
 
 typedef struct {
@@ -163,13 +165,20 @@ uint16_t CHANNELS_GetCountMax();
 void CHANNELS_Load(int16_t num, CH *p);
 void CHANNELS_Save(int16_t num, CH *p);
 bool CHANNELS_LoadBuf();
+uint16_t CHANNELS_GetRevision();
 int16_t CHANNELS_GetCurrentScanlistCH();
 void CHANNELS_Next(bool next);
+bool CHANNELS_InScanlist(int16_t num);
+int16_t CHANNELS_ScanlistStep(int16_t num, bool next);
+int16_t CHANNELS_ScanlistAt(uint16_t index);
+uint16_t CHANNELS_ScanlistIndexOf(int16_t num);
 void CHANNELS_Delete(int16_t i);
 bool CHANNELS_Existing(int16_t i);
 uint16_t CHANNELS_Scanlists(int16_t i);
 void CHANNELS_LoadScanlist(CHTypeFilter type, uint16_t n);
 void CHANNELS_LoadBlacklistToLoot();
+uint8_t CHANNELS_LoadPriority(uint32_t *fs, uint8_t max);
+int16_t CHANNELS_FindPriority(uint32_t f, CH *p);
 
 void CHANNELS_SetScanlistIndexFromRadio();
 
@@ -184,7 +193,7 @@ bool CHANNELS_IsFreqable(CHType type);
 uint16_t CHANNELS_ScanlistByKey(uint16_t sl, KEY_Code_t key, bool longPress);
 
 extern uint16_t gScanlistSize;
-extern uint16_t gScanlist[SCANLIST_MAX];
+extern uint32_t gScanlist[SCANLIST_WORDS]; // 1 bit per MR slot
 extern const char *TX_POWER_NAMES[4];
 extern const char *TX_OFFSET_NAMES[3];
 extern const char *TX_CODE_TYPES[4];
@@ -0,0 +1,141 @@
+#include "finder.h"
+#include "../driver/bk4819.h"
+#include "../driver/st7565.h"
+#include "../driver/uart.h"
+#include "../radio.h"
+#include "../scheduler.h"
+#include "lootlist.h"
+#include "measurements.h"
+
+// Activity finder: BK4819 hardware frequency scan (REG_32) in short windows
+// between normal scanner/multiwatch steps. Hit is checked by tuning to it
+// and reading RSSI, then goes to loot.
+
+#define FINDER_INTERVAL 2000 // ms между окнами
+#define FINDER_WINDOW_MARGIN 50
+#define FINDER_VALIDATE_DELAY 10 // установка RSSI после перестройки
+#define FINDER_FM_BROADCAST_S (88 * MHZ)
+#define FINDER_FM_BROADCAST_E (108 * MHZ)
+
+typedef enum {
+  FINDER_IDLE,
+  FINDER_SCANNING,
+  FINDER_VALIDATING,
+} FinderState;
+
+static const FreqScanTime WINDOW_TIME = F_SC_T_0_2s;
+static const uint16_t SCAN_HZ = 0x244;
+
+static FinderState state = FINDER_IDLE;
+static bool isOn;
+static Filter filter = FILTER_VHF;
+static uint32_t nextWindowTime;
+static uint32_t timeout;
+static uint32_t savedF;
+static uint32_t hitF;
+static uint32_t lastHitF;
+
+static void finish() {
+  BK4819_DisableFrequencyScan();
+  BK4819_RX_TurnOn();
+  // TuneTo ничего не делает, если хита не было: фильтр окна возвращаем сами
+  BK4819_SelectFilter(savedF);
+  BK4819_TuneTo(savedF, true);
+  // следующее окно - другой фильтр
+  filter = filter == FILTER_VHF ? FILTER_UHF : FILTER_VHF;
+  nextWindowTime = Now() + FINDER_INTERVAL;
+  state = FINDER_IDLE;
+}
+
+static bool isHitOk(uint32_t f) {
+  const uint32_t bound = SETTINGS_GetFilterBound();
+  if (f < BK4819_F_MIN || f > BK4819_F_MAX) {
+    return false;
+  }
+  if (f >= FINDER_FM_BROADCAST_S && f <= FINDER_FM_BROADCAST_E) {
+    return false;
+  }
+  // частота должна соответствовать включенному фильтру
+  if ((filter == FILTER_VHF) != (f < bound)) {
+    return false;
+  }
+  Loot *item = LOOT_Get(f);
+  return !(item && item->blacklist);
+}
+
+static void validate() {
+  const uint16_t rssi = BK4819_GetRSSI();
+  const SQL sq = GetSql(RADIO_GetParam(ctx, PARAM_SQUELCH_VALUE));
+  if (rssi >= sq.ro) {
+    Log("[FINDER] hit %u, rssi %u", hitF, rssi);
+    Measurement m = {.f = hitF, .rssi = rssi, .open = true};
+    LOOT_Update(&m);
+    Loot *item = LOOT_Get(hitF);
+    if (item) {
+      item->open = false; // only seen, scanner/listen updates it later
+    }
+    lastHitF = hitF;
+    gRedrawScreen = true;
+  }
+  finish();
+}
+
+void FINDER_Toggle(bool on) {
+  if (!on && state != FINDER_IDLE) {
+    finish();
+  }
+  isOn = on;
+  nextWindowTime = Now();
+}
+
+bool FINDER_IsOn(void) { return isOn; }
+
+uint32_t FINDER_GetLastHit(void) { return lastHitF; }
+
+// Returns true while finder owns BK4819, caller must skip its own step
+bool FINDER_Update(bool canStart) {
+  if (!isOn) {
+    return false;
+  }
+
+  switch (state) {
+  case FINDER_IDLE:
+    if (!canStart || Now() < nextWindowTime) {
+      return false;
+    }
+    savedF = BK4819_GetFrequency();
+    BK4819_SelectFilterEx(filter);
+    BK4819_EnableFrequencyScanEx2(WINDOW_TIME, SCAN_HZ);
+    SetTimeout(&timeout, (200 << WINDOW_TIME) + FINDER_WINDOW_MARGIN);
+    state = FINDER_SCANNING;
+    return true;
+
+  case FINDER_SCANNING: {
+    uint32_t f;
+    if (BK4819_GetFrequencyScanResult(&f)) {
+      BK4819_DisableFrequencyScan();
+      BK4819_RX_TurnOn();
+      if (!isHitOk(f)) {
+        finish();
+        return true;
+      }
+      hitF = RoundToStep(f, StepFrequencyTable[RADIO_GetParam(ctx, PARAM_STEP)]);
+      BK4819_TuneTo(hitF, true);
+      SetTimeout(&timeout, FINDER_VALIDATE_DELAY);
+      state = FINDER_VALIDATING;
+      return true;
+    }
+    if (CheckTimeout(&timeout)) {
+      finish();
+    }
+    return true;
+  }
+
+  case FINDER_VALIDATING:
+    if (CheckTimeout(&timeout)) {
+      validate();
+    }
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,12 @@
+#ifndef FINDER_H
+#define FINDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void FINDER_Toggle(bool on);
+bool FINDER_IsOn(void);
+bool FINDER_Update(bool canStart);
+uint32_t FINDER_GetLastHit(void);
+
+#endif /* end of include guard: FINDER_H */
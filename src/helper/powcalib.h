@@ -0,0 +1,15 @@
+#ifndef POWCALIB_H
+#define POWCALIB_H
+
+#include "channels.h"
+#include <stdint.h>
+
+typedef struct {
+  uint32_t s;
+  uint32_t e;
+  PowerCalibration c;
+} PCal;
+
+PowerCalibration POWCALIB_Interpolate(uint32_t f);
+
+#endif /* end of include guard: POWCALIB_H */
@@ -3,10 +3,27 @@
 #include "../driver/st7565.h"
 #include "../driver/system.h"
 #include "../driver/systick.h"
+#include "../driver/uart.h"
 #include "../radio.h"
 #include "../scheduler.h"
 #include "../ui/spectrum.h"
 #include "bands.h"
+#include "finder.h"
+#include <string.h>
+
+#define COARSE_FACTOR 8 // грубый шаг <= COARSE_FACTOR * шаг пользователя
+#define COARSE_MARGIN 6 // 3 dB над шумом -> уточняем участок
+
+#define EXCL_MAX_STEPS 2048 // 256 байт, длиннее диапазон - без карты
+
+#define ACT_SLOTS 16
+#define ACT_HIT 64          // прибавка к оценке при открытии
+#define ACT_THRESHOLD 1024  // кредит на один внеочередной повтор
+#define ACT_SEED_MS 60000   // loot свежее этого засеивает оценки
+
+#define PRIORITY_MAX 8
+#define PRIORITY_PERIOD 500 // желаемый интервал проверки каждой частоты, мс
+#define PRIORITY_COOLDOWN 50 // минимум между проверками, защищает CPS
 
 // =============================
 // Состояние сканирования
@@ -18,11 +35,23 @@ typedef struct {
   uint32_t scanCycles; // Количество циклов сканирования
   uint32_t lastCpsTime;    // Последнее время замера CPS
   uint32_t lastRenderTime; // Последнее время отрисовки
+  uint32_t thinkingTimeout; // Окончание проверки squelch
+  uint32_t thinkingStart;   // Начало проверки squelch
+  uint32_t thinkingTime; // Время в проверке squelch за период CPS (мс)
+  uint32_t refineEnd; // Конец уточняемого участка (0 - грубый проход)
+  uint32_t resumeF; // Продолжить развертку отсюда после приоритетной частоты
+  uint32_t sweepIndex; // Номер шага развертки от начала диапазона
   uint16_t squelchLevel; // Текущий уровень шумоподавления
-  bool thinking;         // Думоем
+  uint16_t coarseNoise;  // Шум по грубому проходу
+  uint8_t thinkingPercent; // Доля времени проверки за прошлый период CPS
+  bool thinking;           // Думоем
   bool wasThinkingEarlier; // Флаг для корректировки squelch
   bool lastListenState;    // Последнее состояние squelch
   bool isMultiband;        // Мультидиапазонный режим
+  bool twoPass;            // Грубый + точный проход
+  bool adaptive;           // Повторы активных частот между шагами
+  bool skipFresh; // Первый проход после зума: свежие шаги уже из кэша
+  bool isAnalyser; // Режим анализатора
 } ScanState;
 
 static ScanState scan = {
@@ -51,29 +80,321 @@ static uint16_t MeasureSignal(uint32_t frequency, bool precise) {
   return RADIO_GetRSSI(ctx);
 }
 
+// =============================
+// Карта исключенных шагов
+// =============================
+// Один бит на шаг диапазона: blacklist из loot/EEPROM и мусорные частоты.
+// Развертка перепрыгивает исключенные шаги не трогая радио.
+static uint32_t excl[EXCL_MAX_STEPS / 32];
+static uint16_t exclSteps; // 0 - карта не используется
+static uint32_t exclStepHz;
+
+static void ExclSet(uint32_t f) {
+  if (!exclSteps || f < gCurrentBand.rxF || f > gCurrentBand.txF) {
+    return;
+  }
+  const uint32_t offset = f - gCurrentBand.rxF;
+  if (offset % exclStepHz) {
+    return; // не на сетке, развертка туда не попадает
+  }
+  const uint32_t i = offset / exclStepHz;
+  if (i < exclSteps) {
+    excl[i >> 5] |= 1UL << (i & 31);
+  }
+}
+
+static void ExclBuild() {
+  exclStepHz = StepFrequencyTable[gCurrentBand.step];
+  const uint32_t steps = (gCurrentBand.txF - gCurrentBand.rxF) / exclStepHz + 1;
+  memset(excl, 0, sizeof(excl));
+  exclSteps = steps <= EXCL_MAX_STEPS ? steps : 0;
+  if (!exclSteps) {
+    return;
+  }
+
+  for (uint16_t i = 0; i < LOOT_Size(); ++i) {
+    Loot *item = LOOT_Item(i);
+    if (item->blacklist) {
+      ExclSet(item->f);
+    }
+  }
+
+  if (gSettings.skipGarbageFrequencies) {
+    uint32_t g = (gCurrentBand.rxF + GARBAGE_FREQUENCY_MOD - 1) /
+                 GARBAGE_FREQUENCY_MOD * GARBAGE_FREQUENCY_MOD;
+    for (; g <= gCurrentBand.txF; g += GARBAGE_FREQUENCY_MOD) {
+      ExclSet(g);
+    }
+  }
+}
+
+// First allowed step at or after i, >= exclSteps if none
+static uint32_t ExclNext(uint32_t i) {
+  while (i < exclSteps) {
+    const uint32_t allowed = ~excl[i >> 5] >> (i & 31);
+    if (allowed) {
+      return i + __builtin_ctz(allowed);
+    }
+    i = (i | 31) + 1;
+  }
+  return i;
+}
+
+static bool ExclHas(uint32_t f) {
+  if (!exclSteps || f < gCurrentBand.rxF) {
+    return false;
+  }
+  const uint32_t i = (f - gCurrentBand.rxF) / exclStepHz;
+  return i < exclSteps && (excl[i >> 5] & (1UL << (i & 31)));
+}
+
+void SCAN_Exclude(uint32_t f) { ExclSet(f); }
+
+// Начало развертки с первого не исключенного шага
+static void SweepStart() {
+  scan.sweepIndex = ExclNext(0);
+  if (exclSteps && scan.sweepIndex >= exclSteps) {
+    scan.sweepIndex = 0; // исключено всё, сканируем как есть
+  }
+  vfo->msm.f = gCurrentBand.rxF + scan.sweepIndex * exclStepHz;
+}
+
 static void ApplyBandSettings() {
-  vfo->msm.f = gCurrentBand.rxF;
   RADIO_SetParam(ctx, PARAM_STEP, gCurrentBand.step, false);
   RADIO_ApplySettings(ctx);
   SP_Init(&gCurrentBand);
+  ExclBuild();
+  SweepStart();
+  scan.skipFresh = true;
+  scan.coarseNoise = 0; // шум прошлого диапазона здесь не годится
 }
 
-static void NextFrequency() {
-  // TODO: priority cooldown scan
-  uint32_t step = StepFrequencyTable[RADIO_GetParam(ctx, PARAM_STEP)];
-  vfo->msm.f += step;
+// =============================
+// Приоритетные частоты
+// =============================
+typedef struct {
+  uint32_t f;
+  uint32_t lastCheck;
+} PriorityItem;
+
+static PriorityItem priority[PRIORITY_MAX];
+static uint8_t priorityCount;
+static uint32_t priorityCooldown;
+static uint32_t priorityTimeUs;  // мкс на проверки за период CPS
+static uint16_t priorityMaxLat;  // макс. интервал между проверками за период
+static uint16_t priorityLatency; // за прошлый период CPS
+static uint8_t priorityPercent;  // за прошлый период CPS
+
+static void PriorityAdd(uint32_t f) {
+  for (uint8_t i = 0; i < priorityCount; ++i) {
+    if (priority[i].f == f) {
+      return;
+    }
+  }
+  if (priorityCount < PRIORITY_MAX) {
+    priority[priorityCount++] = (PriorityItem){.f = f, .lastCheck = Now()};
+  }
+}
+
+// Channels marked as priority. Whitelisted loot is not used: it is muted
+// outside monitor mode, see LOOT_UpdateEx
+void SCAN_LoadPriority() {
+  uint32_t fs[PRIORITY_MAX];
+  priorityCount = 0;
+  uint8_t n = CHANNELS_LoadPriority(fs, PRIORITY_MAX);
+  for (uint8_t i = 0; i < n; ++i) {
+    PriorityAdd(fs[i]);
+  }
+  Log("Priority: %u", priorityCount);
+}
+
+// Earliest deadline first
+static PriorityItem *PriorityDue() {
+  if (!priorityCount || !CheckTimeout(&priorityCooldown)) {
+    return NULL;
+  }
+  PriorityItem *due = &priority[0];
+  for (uint8_t i = 1; i < priorityCount; ++i) {
+    if (priority[i].lastCheck < due->lastCheck) {
+      due = &priority[i];
+    }
+  }
+  return Now() - due->lastCheck >= PRIORITY_PERIOD ? due : NULL;
+}
+
+bool SCAN_CheckPriority(uint16_t openLevel, uint32_t *f) {
+  PriorityItem *p = PriorityDue();
+  if (!p) {
+    return false;
+  }
+  const uint32_t start = Now();
+  const uint32_t startUs = NowUs();
+  const uint16_t lat = start - p->lastCheck;
+  if (lat > priorityMaxLat) {
+    priorityMaxLat = lat;
+  }
+  p->lastCheck = start;
+
+  Measurement m = {.f = p->f};
+  m.rssi = MeasureSignal(p->f, true);
+  m.open = m.rssi >= openLevel;
+
+  priorityTimeUs += NowUs() - startUs;
+  SetTimeout(&priorityCooldown, PRIORITY_COOLDOWN);
+  *f = p->f;
+  return m.open;
+}
+
+void SCAN_GetPriorityStats(uint16_t *latencyMs, uint8_t *costPercent) {
+  *latencyMs = priorityLatency;
+  *costPercent = priorityPercent;
+}
+
+uint8_t SCAN_GetPriorityCount() { return priorityCount; }
+
+// =============================
+// Адаптивный порядок
+// =============================
+// Недавно активные частоты получают внеочередные повторы пропорционально
+// оценке активности. Повтор не чаще чем через шаг развертки, поэтому любая
+// частота диапазона посещается не реже чем за два обычных прохода.
+typedef struct {
+  uint32_t f;
+  uint16_t credit;
+  uint8_t score;
+} ActivitySlot;
+
+static ActivitySlot activity[ACT_SLOTS];
+
+static void ActivityHit(uint32_t f) {
+  ActivitySlot *slot = &activity[0];
+  for (uint8_t i = 0; i < ACT_SLOTS; ++i) {
+    if (activity[i].f == f) {
+      slot = &activity[i];
+      break;
+    }
+    if (activity[i].score < slot->score) {
+      slot = &activity[i];
+    }
+  }
+  if (slot->f != f) {
+    *slot = (ActivitySlot){.f = f};
+  }
+  slot->score = MIN(slot->score + ACT_HIT, 255);
+}
+
+// Раз за проход диапазона оценки затухают на четверть
+static void ActivityDecay() {
+  for (uint8_t i = 0; i < ACT_SLOTS; ++i) {
+    activity[i].score -= activity[i].score >> 2;
+    if (!activity[i].score) {
+      activity[i].f = 0;
+    }
+  }
+}
+
+static void ActivitySeed() {
+  for (uint8_t i = 0; i < ACT_SLOTS; ++i) {
+    activity[i] = (ActivitySlot){0};
+  }
+  for (uint16_t i = 0; i < LOOT_Size(); ++i) {
+    Loot *item = LOOT_Item(i);
+    if (!item->blacklist && item->lastTimeOpen &&
+        Now() - item->lastTimeOpen < ACT_SEED_MS) {
+      ActivityHit(item->f);
+    }
+  }
+}
+
+// Deficit round robin: every sweep step credits each slot by its score
+static uint32_t ActivityNext() {
+  ActivitySlot *best = NULL;
+  for (uint8_t i = 0; i < ACT_SLOTS; ++i) {
+    ActivitySlot *slot = &activity[i];
+    if (!slot->score || slot->f < gCurrentBand.rxF ||
+        slot->f > gCurrentBand.txF || ExclHas(slot->f)) {
+      continue;
+    }
+    slot->credit = MIN(slot->credit + slot->score, UINT16_MAX);
+    if (slot->credit >= ACT_THRESHOLD &&
+        (!best || slot->credit > best->credit)) {
+      best = slot;
+    }
+  }
+  if (!best) {
+    return 0;
+  }
+  best->credit -= ACT_THRESHOLD;
+  return best->f;
+}
+
+void SCAN_SetAdaptive(bool on) {
+  scan.adaptive = on;
+  ActivitySeed();
+}
+
+bool SCAN_IsAdaptive() { return scan.adaptive; }
+
+static void StopThinking() {
+  if (scan.thinking) {
+    scan.thinking = false;
+    scan.thinkingTime += Now() - scan.thinkingStart;
+  }
+}
+
+// Внеочередная частота (приоритет, повтор активной) не пишется в спектр:
+// иначе столбец развертки закрывается раньше времени, а точка вне диапазона
+// рисуется на краю
+static void AddSweepPoint() {
+  if (!scan.resumeF) {
+    SP_AddPoint(&vfo->msm);
+  }
+}
+
+static void NextFrequencyEx(uint16_t steps) {
+  StopThinking();
+  const bool resumed = scan.resumeF;
+  if (resumed) {
+    // возвращаемся к развертке после внеочередной частоты
+    vfo->msm.f = scan.resumeF;
+    scan.resumeF = 0;
+  } else {
+    scan.sweepIndex = ExclNext(scan.sweepIndex + steps);
+    vfo->msm.f = gCurrentBand.rxF + scan.sweepIndex * exclStepHz;
+    while (scan.skipFresh && vfo->msm.f <= gCurrentBand.txF &&
+           SP_CacheFresh(vfo->msm.f)) {
+      scan.sweepIndex = ExclNext(scan.sweepIndex + 1);
+      vfo->msm.f = gCurrentBand.rxF + scan.sweepIndex * exclStepHz;
+    }
+  }
+  if (scan.refineEnd && vfo->msm.f >= scan.refineEnd) {
+    scan.refineEnd = 0;
+  }
   if (vfo->is_open) {
     vfo->is_open = false;
     RADIO_SwitchAudioToVFO(&gRadioState, gRadioState.active_vfo_index);
   }
 
   if (vfo->msm.f > gCurrentBand.txF) {
+    SP_WaterfallPush();
+    scan.skipFresh = false;
     if (scan.isMultiband) {
       BANDS_SelectBandRelativeByScanlist(true);
       ApplyBandSettings();
     }
-    vfo->msm.f = gCurrentBand.rxF;
+    SweepStart();
+    scan.refineEnd = 0;
     gRedrawScreen = true;
+    ActivityDecay();
+  }
+
+  // анализатор рисует только развертку, повтор ему ничего не даст
+  if (scan.adaptive && !resumed && !scan.isAnalyser) {
+    uint32_t f = ActivityNext();
+    if (f && f != vfo->msm.f) {
+      scan.resumeF = vfo->msm.f;
+      vfo->msm.f = f;
+    }
   }
 
   LOOT_Replace(&vfo->msm, vfo->msm.f);
@@ -82,6 +403,10 @@ static void NextFrequency() {
   scan.scanCycles++;
 }
 
+static void NextFrequency() {
+  NextFrequencyEx(1);
+}
+
 static void NextWithTimeout() {
   if (scan.lastListenState != vfo->is_open) {
     scan.lastListenState = vfo->is_open;
@@ -105,12 +430,32 @@ static void NextWithTimeout() {
 // API функций
 // =============================
 uint32_t SCAN_GetCps() {
-  uint32_t cps = scan.scanCycles * 1000 / (Now() - scan.lastCpsTime);
+  uint32_t elapsed = Now() - scan.lastCpsTime;
+  if (!elapsed) {
+    return 0;
+  }
+  uint32_t cps = scan.scanCycles * 1000 / elapsed;
+  scan.thinkingPercent = MIN(scan.thinkingTime * 100 / elapsed, 100U);
+  scan.thinkingTime = 0;
+  priorityPercent = MIN(priorityTimeUs / 10 / elapsed, 100U);
+  priorityTimeUs = 0;
+  priorityLatency = priorityMaxLat;
+  priorityMaxLat = 0;
   scan.lastCpsTime = Now();
   scan.scanCycles = 0;
   return cps;
 }
 
+uint8_t SCAN_GetThinkingPercent() { return scan.thinkingPercent; }
+
+void SCAN_SetTwoPass(bool on) {
+  scan.twoPass = on;
+  scan.refineEnd = 0;
+  scan.coarseNoise = 0;
+}
+
+bool SCAN_IsTwoPass() { return scan.twoPass; }
+
 void SCAN_setBand(Band b) {
   gCurrentBand = b;
   ApplyBandSettings();
@@ -126,6 +471,46 @@ void SCAN_setEndF(uint32_t f) {
   ApplyBandSettings();
 }
 
+// Панорама анализатора на целое число столбцов: история спектра сдвигается,
+// развертка начинается с открывшихся столбцов
+void SCAN_Pan(int8_t columns) {
+  const uint32_t stepHz = StepFrequencyTable[gCurrentBand.step];
+  const uint32_t span = gCurrentBand.txF - gCurrentBand.rxF;
+  const uint8_t n = columns < 0 ? -columns : columns;
+  if (!span || !n) {
+    return;
+  }
+  uint32_t df = (SP_X2F(n) - gCurrentBand.rxF) / stepHz * stepHz;
+  if (!df) {
+    df = stepHz; // столбец уже шага
+  }
+  if (columns < 0 ? gCurrentBand.rxF < df
+                  : gCurrentBand.txF + df > BK4819_F_MAX) {
+    return;
+  }
+  // сдвиг, округлённый до шага, в столбцах
+  const int16_t shift = SP_F2X(gCurrentBand.rxF + df);
+
+  if (columns < 0) {
+    gCurrentBand.rxF -= df;
+    gCurrentBand.txF -= df;
+  } else {
+    gCurrentBand.rxF += df;
+    gCurrentBand.txF += df;
+  }
+  SP_Pan(&gCurrentBand, columns < 0 ? -shift : shift);
+  ExclBuild();
+
+  SweepStart();
+  if (columns > 0) {
+    scan.sweepIndex = ExclNext((span - df) / stepHz);
+    vfo->msm.f = gCurrentBand.rxF + scan.sweepIndex * exclStepHz;
+  }
+  scan.refineEnd = 0;
+  scan.resumeF = 0;
+  scan.skipFresh = true;
+}
+
 void SCAN_Next(bool up) { NextFrequency(); }
 
 void SCAN_Init(bool multiband) {
@@ -133,6 +518,14 @@ void SCAN_Init(bool multiband) {
   vfo->msm.snr = 0;
   scan.lastCpsTime = Now();
   scan.scanCycles = 0;
+  scan.thinking = false;
+  scan.thinkingTime = 0;
+  scan.refineEnd = 0;
+  scan.coarseNoise = 0;
+  scan.resumeF = 0;
+  CHANNELS_LoadBlacklistToLoot();
+  ActivitySeed();
+  SCAN_LoadPriority();
   ApplyBandSettings();
 }
 
@@ -141,7 +534,7 @@ void SCAN_Init(bool multiband) {
 // =============================
 static void HandleAnalyserMode() {
   vfo->msm.rssi = MeasureSignal(vfo->msm.f, false);
-  SP_AddPoint(&vfo->msm);
+  AddSweepPoint();
   if (Now() - scan.lastRenderTime > 500) {
     gRedrawScreen = true;
     scan.lastRenderTime = Now();
@@ -149,13 +542,67 @@ static void HandleAnalyserMode() {
   NextFrequency();
 }
 
+// Полоса фильтров BK4819, в единицах частоты (10 Гц)
+static const uint16_t BK4819_BW_F[] = {
+    6 * KHZ,  7 * KHZ,  9 * KHZ,  10 * KHZ, 12 * KHZ,
+    14 * KHZ, 17 * KHZ, 20 * KHZ, 23 * KHZ, 26 * KHZ,
+};
+
+// Одна точка грубого шага видит только полосу фильтра, поэтому шаг не
+// шире неё: иначе сигнал между точками пропадёт, а участок будет "тихим"
+static uint8_t CoarseFactor(uint32_t step) {
+  if (ctx->radio_type != RADIO_BK4819 ||
+      ctx->bandwidth >= ARRAY_SIZE(BK4819_BW_F)) {
+    return 1;
+  }
+  const uint32_t k = BK4819_BW_F[ctx->bandwidth] / step;
+  return k > COARSE_FACTOR ? COARSE_FACTOR : k;
+}
+
+// Грубый проход: широкий шаг, без точной перестройки и выдержки.
+// Участок выше шума уточняется обычным сканированием с шагом пользователя.
+// returns true if bin handled (nothing to refine)
+static bool CoarseStep() {
+  const uint32_t step = StepFrequencyTable[RADIO_GetParam(ctx, PARAM_STEP)];
+  const uint8_t factor = CoarseFactor(step);
+  if (factor < 2) {
+    return false; // шаг не уже фильтра, грубый проход ничего не даст
+  }
+  const uint32_t span = step * factor;
+
+  vfo->msm.rssi = MeasureSignal(vfo->msm.f, false);
+  // шум - из оценки спектра, а не из первой точки (она может быть сигналом);
+  // пока оценки нет, уточняем всё подряд
+  const uint16_t noise =
+      scan.coarseNoise ? scan.coarseNoise : SP_GetNoiseFloor();
+  if (!noise || vfo->msm.rssi > noise + COARSE_MARGIN) {
+    // точка видит f +- span/2: уточняем участок вокруг неё, а не после
+    const uint32_t back = MIN((uint32_t)factor / 2, scan.sweepIndex);
+    scan.refineEnd = vfo->msm.f + (factor - back) * step;
+    scan.sweepIndex = ExclNext(scan.sweepIndex - back);
+    vfo->msm.f = gCurrentBand.rxF + scan.sweepIndex * exclStepHz;
+    return false;
+  }
+  scan.coarseNoise = (noise * 7 + vfo->msm.rssi) / 8;
+
+  vfo->msm.open = false;
+  SP_AddPointSpan(&vfo->msm, span);
+  if (Now() - scan.lastRenderTime > 500) {
+    gRedrawScreen = true;
+    scan.lastRenderTime = Now();
+  }
+  NextFrequencyEx(factor);
+  return true;
+}
+
 static void UpdateSquelchAndRssi(bool isAnalyserMode) {
-  if (gSettings.skipGarbageFrequencies &&
+  // с картой мусорные частоты уже пропущены в NextFrequency()
+  if (!exclSteps && gSettings.skipGarbageFrequencies &&
       (RADIO_GetParam(&vfo->context, PARAM_FREQUENCY) % GARBAGE_FREQUENCY_MOD ==
        0)) {
     vfo->msm.open = false;
     vfo->msm.rssi = 0;
-    SP_AddPoint(&vfo->msm);
+    AddSweepPoint();
     return;
   }
   vfo->msm.rssi = MeasureSignal(vfo->msm.f, !isAnalyserMode);
@@ -173,36 +620,72 @@ static void UpdateSquelchAndRssi(bool isAnalyserMode) {
   }
 
   vfo->msm.open = vfo->msm.rssi >= scan.squelchLevel;
-  SP_AddPoint(&vfo->msm);
+  AddSweepPoint();
 }
 
 void SCAN_Check(bool isAnalyserMode) {
-  RADIO_UpdateMultiwatch(&gRadioState);
+  // при проверке squelch не уходим с частоты
+  if (!scan.thinking) {
+    RADIO_UpdateMultiwatch(&gRadioState);
+  }
   RADIO_CheckAndSaveVFO(&gRadioState);
 
+  if (FINDER_Update(!scan.thinking && !vfo->is_open &&
+                    RADIO_IsMultiwatchIdle(&gRadioState))) {
+    return;
+  }
+
+  scan.isAnalyser = isAnalyserMode;
   if (isAnalyserMode) {
+    StopThinking();
     HandleAnalyserMode();
     return;
   }
 
-  if (vfo->msm.open) {
-    RADIO_UpdateSquelch(&gRadioState);
-    vfo->msm.open = vfo->is_open;
-    gRedrawScreen = true;
-  } else {
-    UpdateSquelchAndRssi(isAnalyserMode);
+  uint32_t priorityF;
+  if (!scan.thinking && !vfo->msm.open && !vfo->is_open && !scan.resumeF &&
+      SCAN_CheckPriority(scan.squelchLevel, &priorityF)) {
+    // активность на приоритетной: проверяем её как обычный шаг, окно
+    // уточнения развертки (refineEnd) остаётся до возврата
+    scan.resumeF = vfo->msm.f;
+    vfo->msm.f = priorityF;
+  }
+
+  // внеочередная частота меряется точно и не открывает окно уточнения
+  if (scan.twoPass && !scan.refineEnd && !scan.resumeF && !scan.thinking &&
+      !vfo->msm.open && !vfo->is_open && CoarseStep()) {
+    return;
   }
 
-  if (vfo->msm.open && !vfo->is_open) {
-    scan.thinking = true;
-    scan.wasThinkingEarlier = true;
-    SYS_DelayMs(SQL_DELAY);
+  if (scan.thinking) {
+    // ждём SQL_DELAY не блокируя главный цикл
+    if (!CheckTimeout(&scan.thinkingTimeout)) {
+      return;
+    }
+    StopThinking();
     RADIO_UpdateSquelch(&gRadioState);
     vfo->msm.open = vfo->is_open;
-    scan.thinking = false;
     gRedrawScreen = true;
     if (!vfo->msm.open) {
       scan.squelchLevel++;
+    } else {
+      ActivityHit(vfo->msm.f);
+    }
+  } else {
+    if (vfo->msm.open) {
+      RADIO_UpdateSquelch(&gRadioState);
+      vfo->msm.open = vfo->is_open;
+      gRedrawScreen = true;
+    } else {
+      UpdateSquelchAndRssi(isAnalyserMode);
+    }
+
+    if (vfo->msm.open && !vfo->is_open) {
+      scan.thinking = true;
+      scan.wasThinkingEarlier = true;
+      scan.thinkingStart = Now();
+      SetTimeout(&scan.thinkingTimeout, SQL_DELAY);
+      return;
     }
   }
 
@@ -19,8 +19,19 @@ void SCAN_Init(bool multiband);
 void SCAN_setStartF(uint32_t f);
 void SCAN_setEndF(uint32_t f);
 void SCAN_setBand(Band b);
+void SCAN_Pan(int8_t columns);
 void SCAN_Check(bool isAnalyserMode);
 void SCAN_Next(bool up);
 uint32_t SCAN_GetCps();
+uint8_t SCAN_GetThinkingPercent();
+void SCAN_SetTwoPass(bool on);
+bool SCAN_IsTwoPass();
+void SCAN_Exclude(uint32_t f);
+void SCAN_SetAdaptive(bool on);
+bool SCAN_IsAdaptive();
+void SCAN_LoadPriority();
+bool SCAN_CheckPriority(uint16_t openLevel, uint32_t *f);
+uint8_t SCAN_GetPriorityCount();
+void SCAN_GetPriorityStats(uint16_t *latencyMs, uint8_t *costPercent);
 
 #endif /* end of include guard: SCAN_H */
@@ -0,0 +1,192 @@
+#include "scanplan.h"
+#include "../driver/uart.h"
+#include "../radio.h"
+
+// Scan plan: current scanlist compiled into RAM.
+// Channels with the same RX settings share one register profile (recorded
+// BK4819 writes without frequency), entry keeps only frequency and filter.
+// Hop = stream profile delta + tune, context gets the same RX fields.
+
+typedef struct {
+  uint32_t f : 27;
+  uint8_t profile : 2;
+  Filter filter : 2;
+  uint16_t num;
+} __attribute__((packed)) PlanEntry;
+
+typedef struct {
+  ModulationType modulation;
+  BK4819_FilterBandwidth_t bw;
+  uint8_t gainIndex;
+  Squelch squelch;
+  Code code;
+} ProfileKey;
+
+static PlanEntry entries[SCANPLAN_MAX];
+static uint8_t entriesCount;
+
+static BK4819_Snapshot profiles[SCANPLAN_PROFILES];
+static ProfileKey profileKeys[SCANPLAN_PROFILES];
+static uint8_t profilesCount;
+
+static uint16_t compiledRevision;
+static uint16_t compiledScanlist;
+static bool valid;
+
+static ProfileKey keyOf(const CH *ch) {
+  return (ProfileKey){
+      .modulation = ch->modulation,
+      .bw = ch->bw,
+      .gainIndex = ch->gainIndex,
+      .squelch = ch->squelch,
+      .code = ch->code.rx,
+  };
+}
+
+static bool sameKey(const ProfileKey *a, const ProfileKey *b) {
+  return a->modulation == b->modulation && a->bw == b->bw &&
+         a->gainIndex == b->gainIndex &&
+         a->squelch.type == b->squelch.type &&
+         a->squelch.value == b->squelch.value &&
+         a->code.type == b->code.type && a->code.value == b->code.value;
+}
+
+// frequency goes from entry, not from profile
+static void stripFrequency(BK4819_Snapshot *s) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < s->count; ++i) {
+    if (s->regs[i].reg != BK4819_REG_38 && s->regs[i].reg != BK4819_REG_39) {
+      s->regs[n++] = s->regs[i];
+    }
+  }
+  s->count = n;
+  s->f = 0;
+}
+
+static int8_t profileFor(const CH *ch) {
+  ProfileKey key = keyOf(ch);
+  for (uint8_t i = 0; i < profilesCount; ++i) {
+    if (sameKey(&profileKeys[i], &key)) {
+      return i;
+    }
+  }
+  if (profilesCount >= SCANPLAN_PROFILES) {
+    return -1;
+  }
+
+  // записываем профиль, применив канал к временному контексту
+  VFOContext tmp = gRadioState.vfos[gRadioState.active_vfo_index].context;
+  BK4819_Snapshot *s = &profiles[profilesCount];
+  RADIO_ChannelToContext(&tmp, ch);
+  tmp.dirty = PARAM_ALL_MASK;
+  BK4819_SnapshotRecord(s);
+  RADIO_ApplySettings(&tmp);
+  BK4819_SnapshotStop();
+  if (!s->valid) {
+    return -1;
+  }
+  stripFrequency(s);
+  profileKeys[profilesCount] = key;
+  return profilesCount++;
+}
+
+static int16_t findEntry(int16_t num) {
+  int16_t lo = 0;
+  int16_t hi = entriesCount - 1;
+  while (lo <= hi) {
+    int16_t mid = (lo + hi) >> 1;
+    if (entries[mid].num == num) {
+      return mid;
+    }
+    if (entries[mid].num < num) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return -1;
+}
+
+// Channels which does not fit (count, profiles, other chip) are left out
+// and scanned the usual way.
+bool SCANPLAN_Compile(void) {
+  entriesCount = 0;
+  profilesCount = 0;
+  valid = false;
+
+  int16_t num = -1;
+  for (uint16_t i = 0; i < gScanlistSize && entriesCount < SCANPLAN_MAX; ++i) {
+    num = CHANNELS_ScanlistStep(num, true); // ascending, no wrap here
+    CH ch;
+    CHANNELS_Load(num, &ch);
+    if (ch.meta.type != TYPE_CH || ch.radio != RADIO_BK4819 ||
+        ch.modulation == MOD_BYP) {
+      continue;
+    }
+    int8_t profile = profileFor(&ch);
+    if (profile < 0) {
+      continue;
+    }
+    entries[entriesCount++] = (PlanEntry){
+        .f = ch.rxF,
+        .profile = profile,
+        .filter = BK4819_GetFilterFor(ch.rxF),
+        .num = num,
+    };
+  }
+
+  // профили записывались на живом чипе, возвращаем текущий VFO
+  if (profilesCount) {
+    VFOContext *ctx = &gRadioState.vfos[gRadioState.active_vfo_index].context;
+    ctx->dirty = PARAM_ALL_MASK;
+    RADIO_ApplySettings(ctx);
+  }
+
+  compiledRevision = CHANNELS_GetRevision();
+  compiledScanlist = gSettings.currentScanlist;
+  valid = true;
+  Log("Scan plan: %u entries, %u profiles", entriesCount, profilesCount);
+  return entriesCount > 0;
+}
+
+// Scanlist is a function of its mask and the saved channels, so re-entering
+// the channel scan with the same list reuses the plan
+bool SCANPLAN_IsValid(void) {
+  return valid && compiledRevision == CHANNELS_GetRevision() &&
+         compiledScanlist == gSettings.currentScanlist;
+}
+
+void SCANPLAN_Invalidate(void) { valid = false; }
+
+bool SCANPLAN_Has(int16_t num) {
+  return SCANPLAN_IsValid() && findEntry(num) >= 0;
+}
+
+// Chip is programmed from the plan, so ctx only mirrors it: not dirty
+static void syncContext(VFOContext *ctx, const ProfileKey *k, uint32_t f) {
+  RADIO_SetParam(ctx, PARAM_FREQUENCY, f, false);
+  RADIO_SetParam(ctx, PARAM_MODULATION, k->modulation, false);
+  RADIO_SetParam(ctx, PARAM_BANDWIDTH, k->bw, false);
+  RADIO_SetParam(ctx, PARAM_GAIN, k->gainIndex, false);
+  RADIO_SetParam(ctx, PARAM_SQUELCH_TYPE, k->squelch.type, false);
+  RADIO_SetParam(ctx, PARAM_SQUELCH_VALUE, k->squelch.value, false);
+  ctx->code = k->code;
+  ctx->dirty = 0;
+}
+
+// Context of other chip (or bypass) needs the full load path
+bool SCANPLAN_Apply(int16_t num, VFOContext *ctx) {
+  if (!SCANPLAN_IsValid() || ctx->radio_type != RADIO_BK4819 ||
+      ctx->modulation == MOD_BYP) {
+    return false;
+  }
+  int16_t i = findEntry(num);
+  if (i < 0) {
+    return false;
+  }
+  const PlanEntry *e = &entries[i];
+  BK4819_SnapshotApplyAt(&profiles[e->profile], e->f, e->filter,
+                         ctx->preciseFChange);
+  syncContext(ctx, &profileKeys[e->profile], e->f);
+  return true;
+}
@@ -0,0 +1,19 @@
+#ifndef SCANPLAN_H
+#define SCANPLAN_H
+
+#include "../driver/bk4819.h"
+#include "../radio.h"
+#include "channels.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCANPLAN_MAX 64
+#define SCANPLAN_PROFILES 4
+
+bool SCANPLAN_Compile(void);
+bool SCANPLAN_IsValid(void);
+bool SCANPLAN_Has(int16_t num);
+bool SCANPLAN_Apply(int16_t num, VFOContext *ctx);
+void SCANPLAN_Invalidate(void);
+
+#endif /* end of include guard: SCANPLAN_H */
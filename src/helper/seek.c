@@ -0,0 +1,264 @@
+#include "seek.h"
+#include "../dcs.h"
+#include "../driver/bk1080.h"
+#include "../driver/bk4819.h"
+#include "../driver/si473x.h"
+#include "../driver/uart.h"
+#include "../misc.h"
+#include "../scheduler.h"
+
+// Broadcast seek: SI4732 ищет станции сам (SEEK_START + STCINT), мы только
+// опрашиваем статус и собираем найденное. BK1080 аппаратный seek не
+// поддерживаем, там шагаем по каналам и читаем RSSI/SNR напрямую.
+
+#define SEEK_POLL_INTERVAL 10 // ms между опросами STCINT
+#define SEEK_BK1080_SETTLE 40 // ms установки RSSI/SNR BK1080
+
+const SeekRange SEEK_RANGES[] = {
+    {"FM", 8750000, 10800000, 10000, STEP_100_0kHz, SI47XX_FM, 20, 3},
+    {"MW", 52200, 171000, 900, STEP_9_0kHz, SI47XX_AM, 25, 5},
+    {"SW", 230000, 2610000, 500, STEP_5_0kHz, SI47XX_AM, 25, 5},
+    {"LW", 15300, 27900, 900, STEP_9_0kHz, SI47XX_AM, 25, 5},
+};
+const uint8_t SEEK_RANGES_COUNT = ARRAY_SIZE(SEEK_RANGES);
+
+static Station stations[SEEK_STATIONS_MAX];
+static uint8_t stationsCount;
+
+static const SeekRange *range;
+static Radio seekRadio;
+static bool isRunning;
+static uint32_t currentF;
+static uint32_t pollTimeout;
+static uint32_t startTime;
+static uint32_t lastTime;
+
+static Station *find(uint32_t f) {
+  for (uint8_t i = 0; i < stationsCount; ++i) {
+    if (stations[i].f == f) {
+      return &stations[i];
+    }
+  }
+  return NULL;
+}
+
+// Сильная станция видна и на соседних каналах: оставляем самый сильный
+static void addStation(uint32_t f, uint8_t rssi, uint8_t snr) {
+  Station *s = find(f);
+  if (!s && stationsCount) {
+    Station *last = &stations[stationsCount - 1];
+    if (last->mode == range->mode && last->f + range->spacing == f) {
+      if (last->rssi >= rssi) {
+        return;
+      }
+      s = last;
+    }
+  }
+  if (!s) {
+    if (stationsCount >= SEEK_STATIONS_MAX) {
+      return;
+    }
+    s = &stations[stationsCount++];
+  }
+  s->f = f;
+  s->rssi = rssi;
+  s->snr = snr;
+  s->mode = range->mode;
+  Log("[SEEK] %u rssi=%u snr=%u", f, rssi, snr);
+}
+
+static void finish() {
+  isRunning = false;
+  lastTime = Now() - startTime;
+  LogC(LOG_C_BRIGHT_YELLOW, "[SEEK] %s done: %u stations, %ums", range->name,
+       stationsCount, lastTime);
+}
+
+static void bk1080Tune(uint32_t f) {
+  currentF = f;
+  BK1080_SetFrequency(f);
+  SetTimeout(&pollTimeout, SEEK_BK1080_SETTLE);
+}
+
+bool SEEK_Start(Radio radio, uint8_t r) {
+  if (r >= SEEK_RANGES_COUNT) {
+    return false;
+  }
+  range = &SEEK_RANGES[r];
+  seekRadio = radio;
+
+  switch (radio) {
+  case RADIO_SI4732:
+    SI47XX_Resume(range->mode);
+    SI47XX_TuneSync(range->start / (range->mode == SI47XX_FM ? 1000 : 100));
+    if (range->mode == SI47XX_FM) {
+      SI47XX_SetSeekFmLimits(range->start, range->end);
+      SI47XX_SetSeekFmSpacing(range->spacing);
+      SI47XX_SetSeekFmRssiThreshold(range->rssiMin);
+      SI47XX_SetSeekFmSnrThreshold(range->snrMin);
+    } else {
+      SI47XX_SetSeekAmLimits(range->start, range->end);
+      SI47XX_SetSeekAmSpacing(range->spacing);
+      SI47XX_SetSeekAmRssiThreshold(range->rssiMin);
+      SI47XX_SetSeekAmSnrThreshold(range->snrMin);
+    }
+    currentF = range->start;
+    SI47XX_Seek(true, false);
+    SetTimeout(&pollTimeout, SEEK_POLL_INTERVAL);
+    break;
+  case RADIO_BK1080:
+    if (range->mode != SI47XX_FM) {
+      return false;
+    }
+    BK1080_Init(range->start, true);
+    bk1080Tune(range->start);
+    break;
+  default:
+    return false;
+  }
+
+  startTime = Now();
+  isRunning = true;
+  LogC(LOG_C_BRIGHT_YELLOW, "[SEEK] %s start", range->name);
+  return true;
+}
+
+void SEEK_Stop(void) {
+  if (!isRunning) {
+    return;
+  }
+  if (seekRadio == RADIO_SI4732) {
+    SI47xx_GetStatus(1, 1); // отмена seek
+  }
+  finish();
+}
+
+static void updateSi() {
+  SI47XX_SeekResult r;
+  if (!SI47XX_SeekPoll(&r)) {
+    return;
+  }
+  currentF = r.f;
+  if (r.valid && r.f >= range->start && r.f <= range->end) {
+    addStation(r.f, r.rssi, r.snr);
+  }
+  if (r.bandLimit || r.f >= range->end) {
+    finish();
+    return;
+  }
+  SI47XX_Seek(true, false);
+}
+
+static void updateBK1080() {
+  const uint8_t snr = BK1080_GetSNR();
+  if (snr >= range->snrMin) {
+    addStation(currentF, BK1080_GetRSSI() >> 1, snr);
+  }
+  if (currentF + range->spacing > range->end) {
+    finish();
+    return;
+  }
+  bk1080Tune(currentF + range->spacing);
+}
+
+// Returns true when position or station list changed
+bool SEEK_Update(void) {
+  if (!isRunning || !CheckTimeout(&pollTimeout)) {
+    return false;
+  }
+  const uint32_t f = currentF;
+  const uint8_t n = stationsCount;
+  if (seekRadio == RADIO_SI4732) {
+    SetTimeout(&pollTimeout, SEEK_POLL_INTERVAL);
+    updateSi();
+  } else {
+    updateBK1080();
+  }
+  return f != currentF || n != stationsCount || !isRunning;
+}
+
+bool SEEK_IsRunning(void) { return isRunning; }
+
+uint32_t SEEK_GetF(void) { return currentF; }
+
+uint8_t SEEK_GetProgress(void) {
+  if (!range || currentF <= range->start) {
+    return 0;
+  }
+  if (currentF >= range->end) {
+    return 100;
+  }
+  return (currentF - range->start) * 100 / (range->end - range->start);
+}
+
+uint32_t SEEK_GetLastTime(void) { return lastTime; }
+
+uint8_t SEEK_Count(void) { return stationsCount; }
+
+const Station *SEEK_Get(uint8_t i) {
+  return i < stationsCount ? &stations[i] : NULL;
+}
+
+void SEEK_Clear(void) { stationsCount = 0; }
+
+CH SEEK_ToCh(const Station *s, Radio radio) {
+  Step step = STEP_100_0kHz;
+  for (uint8_t i = 0; i < SEEK_RANGES_COUNT; ++i) {
+    if (SEEK_RANGES[i].mode == s->mode && s->f >= SEEK_RANGES[i].start &&
+        s->f <= SEEK_RANGES[i].end) {
+      step = SEEK_RANGES[i].step;
+      break;
+    }
+  }
+  CH ch = {
+      .meta.type = TYPE_CH,
+      .rxF = s->f,
+      .txF = 0,
+      .radio = radio,
+      .modulation = radio == RADIO_BK1080 ? MOD_WFM : s->mode,
+      .step = step,
+      .code =
+          (CodeRXTX){
+              .rx.type = CODE_TYPE_OFF,
+              .tx.type = CODE_TYPE_OFF,
+          },
+  };
+  mhzToS(ch.name, ch.rxF);
+  return ch;
+}
+
+// Сохраняет станции в свободные каналы с конца, уже сохранённые пропускает
+uint16_t SEEK_SaveAll(Radio radio, uint16_t scanlist) {
+  uint64_t known = 0; // бит i: станция i уже есть в каналах
+  const uint16_t max = CHANNELS_GetCountMax();
+  for (uint16_t n = 0; n < max; ++n) {
+    if (CHANNELS_GetMeta(n).type != TYPE_CH) {
+      continue;
+    }
+    CH ch;
+    CHANNELS_Load(n, &ch);
+    for (uint8_t i = 0; i < stationsCount; ++i) {
+      if (ch.rxF == stations[i].f) {
+        known |= 1ULL << i;
+      }
+    }
+  }
+
+  uint16_t saved = 0;
+  int16_t n = max;
+  for (uint8_t i = 0; i < stationsCount; ++i) {
+    if (known & (1ULL << i)) {
+      continue;
+    }
+    while (--n >= 0 && CHANNELS_GetMeta(n).type != TYPE_EMPTY) {
+    }
+    if (n < 0) {
+      break;
+    }
+    CH ch = SEEK_ToCh(&stations[i], radio);
+    ch.scanlists = scanlist;
+    CHANNELS_Save(n, &ch);
+    saved++;
+  }
+  return saved;
+}
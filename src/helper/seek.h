@@ -0,0 +1,44 @@
+#ifndef SEEK_H
+#define SEEK_H
+
+#include "channels.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SEEK_STATIONS_MAX 48
+
+typedef struct {
+  const char *name;
+  uint32_t start;
+  uint32_t end;
+  uint16_t spacing;
+  Step step;
+  uint8_t mode; // SI47XX_MODE
+  uint8_t rssiMin;
+  uint8_t snrMin;
+} SeekRange;
+
+typedef struct {
+  uint32_t f;
+  uint8_t rssi;
+  uint8_t snr;
+  uint8_t mode;
+} Station;
+
+extern const SeekRange SEEK_RANGES[];
+extern const uint8_t SEEK_RANGES_COUNT;
+
+bool SEEK_Start(Radio radio, uint8_t range);
+void SEEK_Stop(void);
+bool SEEK_Update(void);
+bool SEEK_IsRunning(void);
+uint32_t SEEK_GetF(void);
+uint8_t SEEK_GetProgress(void);
+uint32_t SEEK_GetLastTime(void);
+uint8_t SEEK_Count(void);
+const Station *SEEK_Get(uint8_t i);
+void SEEK_Clear(void);
+CH SEEK_ToCh(const Station *s, Radio radio);
+uint16_t SEEK_SaveAll(Radio radio, uint16_t scanlist);
+
+#endif /* end of include guard: SEEK_H */
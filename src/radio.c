@@ -10,6 +10,7 @@
 #include "driver/system.h"
 #include "driver/uart.h"
 #include "external/printf/printf.h"
+#include "helper/bands.h"
 #include "helper/battery.h"
 #include "helper/channels.h"
 #include "helper/lootlist.h"
@@ -21,6 +22,7 @@
 #include <string.h>
 
 #define RADIO_SAVE_DELAY_MS 1000
+#define VFO_SNAPSHOTS 4
 
 // #define DEBUG_PARAMS 1
 
@@ -31,6 +33,12 @@ RadioState gRadioState;
 ExtendedVFOContext *vfo;
 VFOContext *ctx;
 
+// Снимки регистров для multiwatch: общий пул на недавно посещённые VFO,
+// а не снимок в каждом из MAX_VFOS
+static BK4819_Snapshot snapshots[VFO_SNAPSHOTS];
+static uint8_t snapshotOwner[VFO_SNAPSHOTS]; // индекс VFO, UINT8_MAX - пусто
+static uint8_t snapshotNext;
+
 const char *RADIO_NAMES[3] = {
     [RADIO_BK4819] = "BK4819",
     [RADIO_BK1080] = "BK1080",
@@ -316,7 +324,9 @@ static void rxTurnOff(Radio r) {
     BK1080_Mute(true);
     break;
   case RADIO_SI4732:
-    if (gSettings.si4732PowerOff) {
+    // с патчем выключение стоит повторной загрузки, держим чип без звука
+    if (gSettings.si4732PowerOff &&
+        !(gSettings.si4732KeepSsb && SI47XX_IsPatched())) {
       SI47XX_PowerDown();
     } else {
       SI47XX_SetVolume(0);
@@ -339,15 +349,7 @@ static void rxTurnOn(const VFOContext *ctx) {
     break;
   case RADIO_SI4732:
     BK4819_Idle();
-    if (gSettings.si4732PowerOff || !isSi4732On) {
-      if (RADIO_IsSSB(ctx)) {
-        SI47XX_PatchPowerUp();
-      } else {
-        SI47XX_PowerUp();
-      }
-    } else {
-      SI47XX_SetVolume(63);
-    }
+    SI47XX_Resume((SI47XX_MODE)ctx->modulation);
     break;
   default:
     break;
@@ -659,9 +661,7 @@ void RADIO_SetParam(VFOContext *ctx, ParamType param, uint32_t value,
     break;
   case PARAM_RADIO:
     ctx->radio_type = value;
-    for (uint8_t i = 0; i < PARAM_COUNT; ++i) {
-      ctx->dirty[i] = true;
-    }
+    ctx->dirty = PARAM_ALL_MASK;
     break;
   case PARAM_COUNT:
     return;
@@ -674,7 +674,8 @@ void RADIO_SetParam(VFOContext *ctx, ParamType param, uint32_t value,
 
   // TODO: make dirty only when changed.
   // but, potential BUG: param not applied when 0
-  ctx->dirty[param] = true;
+  ctx->dirty |= PARAM_BIT(param);
+  ctx->snapshot_dirty = true;
 
   // Если значение изменилось и требуется сохранение - устанавливаем флаг
   if (save_to_eeprom && (old_value != value)) {
@@ -724,7 +725,7 @@ uint32_t RADIO_GetParam(const VFOContext *ctx, ParamType param) {
   case PARAM_RADIO:
     return ctx->radio_type;
   case PARAM_POWER:
-    return ctx->tx_state.power_level;
+    return ctx->power;
   case PARAM_AFC:
     return ctx->afc;
   case PARAM_XTAL:
@@ -812,6 +813,35 @@ bool RADIO_IncDecParam(VFOContext *ctx, ParamType param, bool inc,
 
 typedef bool (*spf_ptr)(VFOContext *, ParamType);
 
+static const uint32_t NOT_APPLIED_MASK =
+    PARAM_BIT(PARAM_STEP) | PARAM_BIT(PARAM_POWER) |
+    PARAM_BIT(PARAM_TX_OFFSET) | PARAM_BIT(PARAM_TX_STATE) |
+    PARAM_BIT(PARAM_TX_CODE) | PARAM_BIT(PARAM_RX_CODE) |
+    PARAM_BIT(PARAM_RSSI) | PARAM_BIT(PARAM_NOISE) | PARAM_BIT(PARAM_GLITCH) |
+    PARAM_BIT(PARAM_SNR) | PARAM_BIT(PARAM_PRECISE_F_CHANGE);
+
+// Параметры, которые имеет смысл сравнивать при переключении VFO:
+// измерения (RSSI, ...) читаются с чипа, шаг/мощность/сдвиг на RX не влияют
+static const uint32_t SWITCH_DIFF_MASK =
+    PARAM_ALL_MASK &
+    ~(PARAM_BIT(PARAM_STEP) | PARAM_BIT(PARAM_POWER) |
+      PARAM_BIT(PARAM_TX_OFFSET) | PARAM_BIT(PARAM_RSSI) |
+      PARAM_BIT(PARAM_NOISE) | PARAM_BIT(PARAM_GLITCH) |
+      PARAM_BIT(PARAM_SNR) | PARAM_BIT(PARAM_PRECISE_F_CHANGE));
+
+static uint32_t diffParams(const VFOContext *a, const VFOContext *b) {
+  uint32_t diff = 0;
+  uint32_t mask = SWITCH_DIFF_MASK;
+  while (mask) {
+    const uint8_t p = __builtin_ctz(mask);
+    mask &= mask - 1;
+    if (RADIO_GetParam(a, p) != RADIO_GetParam(b, p)) {
+      diff |= PARAM_BIT(p);
+    }
+  }
+  return diff;
+}
+
 static spf_ptr setParamForRadio[] = {
     [RADIO_BK4819] = &setParamBK4819,
     [RADIO_BK1080] = &setParamBK1080,
@@ -820,37 +850,24 @@ static spf_ptr setParamForRadio[] = {
 
 // Применение настроек
 void RADIO_ApplySettings(VFOContext *ctx) {
-  if (ctx->dirty[PARAM_RADIO]) {
+  if (ctx->dirty & PARAM_BIT(PARAM_RADIO)) {
     LogC(LOG_C_BRIGHT_MAGENTA, "[RADIO] Change to %s",
          RADIO_GetParamValueString(ctx, PARAM_RADIO));
-    ctx->dirty[PARAM_RADIO] = false;
+    ctx->dirty &= ~PARAM_BIT(PARAM_RADIO);
   }
 
   const bool needSetupToneDetection =
-      (ctx->dirty[PARAM_RX_CODE] || ctx->dirty[PARAM_TX_CODE] ||
-       ctx->dirty[PARAM_TX_STATE]) &&
+      (ctx->dirty & (PARAM_BIT(PARAM_RX_CODE) | PARAM_BIT(PARAM_TX_CODE) |
+                     PARAM_BIT(PARAM_TX_STATE))) &&
       ctx->radio_type == RADIO_BK4819;
 
-  for (uint8_t p = 0; p < PARAM_COUNT; ++p) {
-    if (!ctx->dirty[p]) {
-      continue;
-    }
+  // не применяются к чипу напрямую, только сбрасываем
+  ctx->dirty &= ~NOT_APPLIED_MASK;
 
-    switch (p) {
-    case PARAM_STEP:
-    case PARAM_POWER:
-    case PARAM_TX_OFFSET:
-    case PARAM_TX_STATE:
-    case PARAM_TX_CODE:
-    case PARAM_RX_CODE:
-    case PARAM_RSSI:
-    case PARAM_NOISE:
-    case PARAM_GLITCH:
-    case PARAM_SNR:
-    case PARAM_PRECISE_F_CHANGE:
-      ctx->dirty[p] = false;
-      continue;
-    }
+  uint32_t pending = ctx->dirty;
+  while (pending) {
+    const uint8_t p = __builtin_ctz(pending);
+    pending &= pending - 1;
 
     if (!setParamForRadio[ctx->radio_type](ctx, p)) {
 #ifdef DEBUG_PARAMS
@@ -859,7 +876,7 @@ void RADIO_ApplySettings(VFOContext *ctx) {
 #endif
       continue;
     }
-    ctx->dirty[p] = false;
+    ctx->dirty &= ~PARAM_BIT(p);
 
 #ifdef DEBUG_PARAMS
     LogC(LOG_C_BRIGHT_WHITE, "[SET] %-12s -> %s", PARAM_NAMES[p],
@@ -882,7 +899,10 @@ bool RADIO_StartTX(VFOContext *ctx) {
   if (ctx->tx_state.is_active)
     return true;
 
-  uint8_t power = ctx->tx_state.power_level;
+  // PA bias from the selected power level and calibration for the TX
+  // frequency (tx_state.power_level is never set and gave bias 0)
+  uint8_t power =
+      BANDS_CalculateOutputPower(ctx->power, ctx->tx_state.frequency);
 
   BK4819_ToggleGpioOut(BK4819_GPIO0_PIN28_RX_ENABLE, false);
 
@@ -939,6 +959,7 @@ bool RADIO_IsSSB(const VFOContext *ctx) {
 void RADIO_InitState(RadioState *state, uint8_t num_vfos) {
   Log("RADIO_InitState()");
   memset(state, 0, sizeof(RadioState));
+  memset(snapshotOwner, UINT8_MAX, sizeof(snapshotOwner));
   state->num_vfos = (num_vfos > MAX_VFOS) ? MAX_VFOS : num_vfos;
 
   state->primary_vfo_index = state->active_vfo_index = gSettings.activeVFO;
@@ -977,6 +998,26 @@ void RADIO_CheckAndSaveVFO(RadioState *state) {
   }
 }
 
+static BK4819_Snapshot *findSnapshot(uint8_t vfo_index) {
+  for (uint8_t i = 0; i < VFO_SNAPSHOTS; ++i) {
+    if (snapshotOwner[i] == vfo_index) {
+      return &snapshots[i];
+    }
+  }
+  return NULL;
+}
+
+// Слот под запись снимка VFO, чужой вытесняется по кругу
+static BK4819_Snapshot *takeSnapshot(uint8_t vfo_index) {
+  BK4819_Snapshot *s = findSnapshot(vfo_index);
+  if (!s) {
+    s = &snapshots[snapshotNext];
+    snapshotOwner[snapshotNext] = vfo_index;
+    snapshotNext = (snapshotNext + 1) % VFO_SNAPSHOTS;
+  }
+  return s;
+}
+
 static bool RADIO_SwitchVFOTemp(RadioState *state, uint8_t vfo_index) {
   if (vfo_index >= state->num_vfos) {
     return false;
@@ -989,9 +1030,27 @@ static bool RADIO_SwitchVFOTemp(RadioState *state, uint8_t vfo_index) {
 
   VFOContext *oldCtx = &state->vfos[state->active_vfo_index].context;
   VFOContext *newCtx = &state->vfos[vfo_index].context;
-
-  for (uint8_t p = 0; p < PARAM_COUNT; ++p) {
-    newCtx->dirty[p] = RADIO_GetParam(oldCtx, p) != RADIO_GetParam(newCtx, p);
+  BK4819_Snapshot *regs = findSnapshot(vfo_index);
+
+  const bool canUseSnapshot = oldCtx->radio_type == RADIO_BK4819 &&
+                              newCtx->radio_type == RADIO_BK4819 &&
+                              oldCtx->modulation != MOD_BYP &&
+                              newCtx->modulation != MOD_BYP;
+
+  if (canUseSnapshot && regs && regs->valid && !newCtx->snapshot_dirty) {
+    // регистры уже собраны, пишем только отличающиеся
+    BK4819_SnapshotApply(regs);
+    newCtx->dirty = 0;
+  } else if (canUseSnapshot) {
+    // полное применение с записью снимка
+    newCtx->dirty = PARAM_ALL_MASK;
+    regs = takeSnapshot(vfo_index);
+    BK4819_SnapshotRecord(regs);
+    RADIO_ApplySettings(newCtx);
+    BK4819_SnapshotStop();
+    newCtx->snapshot_dirty = false;
+  } else {
+    newCtx->dirty = diffParams(oldCtx, newCtx);
   }
 
   // mute previous vfo (fast fix)
@@ -1006,7 +1065,9 @@ static bool RADIO_SwitchVFOTemp(RadioState *state, uint8_t vfo_index) {
   // updateContext();
 
   // Apply settings for the new VFO
-  RADIO_ApplySettings(&state->vfos[vfo_index].context);
+  if (newCtx->dirty) {
+    RADIO_ApplySettings(newCtx);
+  }
 
   return true;
 }
@@ -1027,9 +1088,7 @@ bool RADIO_SwitchVFO(RadioState *state, uint8_t vfo_index) {
   VFOContext *oldCtx = &state->vfos[state->active_vfo_index].context;
   VFOContext *newCtx = &state->vfos[vfo_index].context;
 
-  for (uint8_t p = 0; p < PARAM_COUNT; ++p) {
-    newCtx->dirty[p] = RADIO_GetParam(oldCtx, p) != RADIO_GetParam(newCtx, p);
-  }
+  newCtx->dirty = diffParams(oldCtx, newCtx);
 
   // mute previous vfo (fast fix)
   state->vfos[state->active_vfo_index].is_open = false;
@@ -1142,34 +1201,51 @@ void RADIO_LoadChannelToVFO(RadioState *state, uint8_t vfo_index,
 
   LogC(LOG_C_BRIGHT_CYAN, "[RADIO] LoadChannel %u to VFO", channel_index);
 
-  ExtendedVFOContext *vfo = &state->vfos[vfo_index];
-  VFOContext *ctx = &vfo->context;
   CH channel;
   CHANNELS_Load(channel_index, &channel);
+  RADIO_ChannelToVFO(state, vfo_index, channel_index, &channel);
+}
+
+// Same as RADIO_LoadChannelToVFO, but channel is already in RAM
+void RADIO_ChannelToVFO(RadioState *state, uint8_t vfo_index,
+                        uint16_t channel_index, const CH *ch) {
+  if (vfo_index >= state->num_vfos) {
+    return;
+  }
+
+  ExtendedVFOContext *vfo = &state->vfos[vfo_index];
 
   vfo->mode = MODE_CHANNEL;
   vfo->channel_index = channel_index;
 
+  RADIO_ChannelToContext(&vfo->context, ch);
+
+  // RADIO_ApplySettings(&vfo->context);
+}
+
+void RADIO_ChannelToContext(VFOContext *ctx, const CH *ch) {
   // Set parameters from channel
-  RADIO_SetParam(ctx, PARAM_RADIO, channel.radio, false);
-  RADIO_SetParam(ctx, PARAM_BANDWIDTH, channel.bw, false);
-  RADIO_SetParam(ctx, PARAM_FREQUENCY, channel.rxF, false);
-  RADIO_SetParam(ctx, PARAM_GAIN, channel.gainIndex, false);
-  RADIO_SetParam(ctx, PARAM_MODULATION, channel.modulation, false);
-  RADIO_SetParam(ctx, PARAM_POWER, channel.power, false);
-  RADIO_SetParam(ctx, PARAM_SQUELCH_TYPE, channel.squelch.type, false);
-  RADIO_SetParam(ctx, PARAM_SQUELCH_VALUE, channel.squelch.value, false);
-  RADIO_SetParam(ctx, PARAM_STEP, channel.step, false);
+  // смена чипа помечает всё, иначе только то, что задаёт канал
+  if (ctx->radio_type != ch->radio) {
+    RADIO_SetParam(ctx, PARAM_RADIO, ch->radio, false);
+  }
+  RADIO_SetParam(ctx, PARAM_BANDWIDTH, ch->bw, false);
+  RADIO_SetParam(ctx, PARAM_FREQUENCY, ch->rxF, false);
+  RADIO_SetParam(ctx, PARAM_GAIN, ch->gainIndex, false);
+  RADIO_SetParam(ctx, PARAM_MODULATION, ch->modulation, false);
+  RADIO_SetParam(ctx, PARAM_POWER, ch->power, false);
+  RADIO_SetParam(ctx, PARAM_SQUELCH_TYPE, ch->squelch.type, false);
+  RADIO_SetParam(ctx, PARAM_SQUELCH_VALUE, ch->squelch.value, false);
+  RADIO_SetParam(ctx, PARAM_STEP, ch->step, false);
 
   RADIO_SetParam(ctx, PARAM_XTAL, XTAL_2_26M, false);
 
   RADIO_SetParam(ctx, PARAM_PRECISE_F_CHANGE, true, false);
   RADIO_SetParam(ctx, PARAM_VOLUME, 100, false);
 
-  ctx->code = channel.code.rx;
-  ctx->tx_state.code = channel.code.tx;
-
-  // RADIO_ApplySettings(&vfo->context);
+  ctx->code = ch->code.rx;
+  ctx->tx_state.code = ch->code.tx;
+  ctx->dirty |= PARAM_BIT(PARAM_RX_CODE) | PARAM_BIT(PARAM_TX_CODE);
 }
 
 /**
@@ -1217,6 +1293,10 @@ bool RADIO_ToggleVFOMode(RadioState *state, uint8_t vfo_index) {
 // Toggle multiwatch on/off
 void RADIO_ToggleMultiwatch(RadioState *state, bool enable) {
   state->multiwatch_enabled = enable;
+  // глобальные настройки (sql delays, filter bound) могли измениться
+  for (uint8_t i = 0; i < state->num_vfos; ++i) {
+    state->vfos[i].context.snapshot_dirty = true;
+  }
   if (!enable) {
     // Return to the primary VFO when disabling multiwatch
     RADIO_SwitchVFO(state, 0);
@@ -1260,6 +1340,47 @@ void RADIO_UpdateSquelch(RadioState *state) {
     RADIO_SwitchAudioToVFO(state, state->active_vfo_index);
   }
 }
+
+#define MW_DWELL_MIN 8
+#define MW_DWELL_MAX (SQL_DELAY * 2)
+#define MW_DWELL_MARGIN 4
+#define MW_RSSI_SETTLE_SPAN 8 // 4 dB: размах RSSI в окне, шум дрожит сильнее 2 dB
+#define MW_SETTLE_SAMPLES 3   // столько замеров подряд в окне = устоялось
+#define MW_ACTIVE_HOLD 5000   // недавно активные VFO слушаем не меньше SQL_DELAY
+
+// Время прогрева после переключения на VFO
+static uint8_t getDwell(const ExtendedVFOContext *v, uint32_t now) {
+  uint8_t dwell = v->dwell ? v->dwell : SQL_DELAY;
+  if (v->last_activity_time && now - v->last_activity_time < MW_ACTIVE_HOLD &&
+      dwell < SQL_DELAY) {
+    dwell = SQL_DELAY;
+  }
+  return dwell;
+}
+
+// settle: когда RSSI/шумодав перестали меняться после переключения.
+// Если сигнал менялся до конца прогрева -- прогрев был мал, удваиваем.
+static void learnDwell(ExtendedVFOContext *v, uint8_t dwell, uint32_t settle) {
+  uint32_t target = settle + MW_DWELL_MARGIN >= dwell ? dwell * 2
+                                                       : settle + MW_DWELL_MARGIN;
+  uint8_t cur = v->dwell ? v->dwell : SQL_DELAY;
+  uint32_t next = (cur * 3 + target) / 4;
+  v->dwell = next < MW_DWELL_MIN   ? MW_DWELL_MIN
+             : next > MW_DWELL_MAX ? MW_DWELL_MAX
+                                   : next;
+}
+
+// Между циклами мультивотч не держит чип: окно частотомера не собьёт прогрев
+bool RADIO_IsMultiwatchIdle(const RadioState *state) {
+  return state->scan_state == RADIO_SCAN_STATE_IDLE ||
+         state->scan_state == RADIO_SCAN_STATE_SWITCHING;
+}
+
+// Для экрана: прогрев VFO в мультивотче, мс
+uint8_t RADIO_GetMultiwatchDwell(const RadioState *state, uint8_t i) {
+  return getDwell(&state->vfos[i], Now());
+}
+
 // Update multiwatch state (should be called periodically)
 
 void RADIO_UpdateMultiwatch(RadioState *state) {
@@ -1270,11 +1391,25 @@ void RADIO_UpdateMultiwatch(RadioState *state) {
 
   static int8_t current_scan_vfo = 0;
   static uint32_t last_scan_time = 0;
+  static uint32_t cycle_start = 0;
+  // отслеживание стабилизации после переключения
+  static bool learning;
+  static uint8_t dwell;
+  static uint32_t settled_at;
+  static uint32_t last_sample_time;
+  static uint16_t run_min; // окно RSSI текущей серии стабильных замеров
+  static uint16_t run_max;
+  static uint8_t stable;
+  static bool last_open;
   uint32_t current_time = Now();
 
   switch (state->scan_state) {
   case RADIO_SCAN_STATE_IDLE:
     // Log("IDLE");
+    if (cycle_start) {
+      state->cycle_time = current_time - cycle_start;
+    }
+    cycle_start = current_time;
     // Начинаем новый цикл сканирования
     current_scan_vfo = -1;
     state->scan_state = RADIO_SCAN_STATE_SWITCHING;
@@ -1293,12 +1428,47 @@ void RADIO_UpdateMultiwatch(RadioState *state) {
     // Log("SW %u", state->vfos[current_scan_vfo].context.frequency);
     state->scan_state = RADIO_SCAN_STATE_WARMUP;
     last_scan_time = current_time;
+    dwell = getDwell(&state->vfos[current_scan_vfo], current_time);
+    learning = true;
+    settled_at = last_sample_time = current_time;
+    run_min = run_max = BK4819_GetRSSI();
+    stable = 0;
+    last_open = BK4819_IsSquelchOpen();
     break;
 
   case RADIO_SCAN_STATE_WARMUP:
     // Log("WU");
-    // Ждем стабилизации сигнала
-    if (last_scan_time && current_time - last_scan_time >= SQL_DELAY) {
+    if (!last_scan_time) {
+      break;
+    }
+    // Ждем стабилизации: MW_SETTLE_SAMPLES замеров подряд укладываются в
+    // окно MW_RSSI_SETTLE_SPAN, settled_at -- начало этой серии
+    if (learning && stable < MW_SETTLE_SAMPLES &&
+        current_time != last_sample_time) {
+      last_sample_time = current_time;
+      uint16_t rssi = BK4819_GetRSSI();
+      bool open = BK4819_IsSquelchOpen();
+      uint16_t lo = MIN(run_min, rssi);
+      uint16_t hi = rssi > run_max ? rssi : run_max;
+      if (hi - lo > MW_RSSI_SETTLE_SPAN || open != last_open) {
+        run_min = run_max = rssi;
+        stable = 0;
+        settled_at = current_time;
+      } else {
+        run_min = lo;
+        run_max = hi;
+        stable++;
+      }
+      last_open = open;
+    }
+    if (current_time - last_scan_time >= dwell) {
+      if (learning) {
+        // не устоялось за прогрев -- learnDwell удвоит его
+        learnDwell(&state->vfos[current_scan_vfo], dwell,
+                   stable >= MW_SETTLE_SAMPLES ? settled_at - last_scan_time
+                                               : dwell);
+        learning = false;
+      }
       state->scan_state = RADIO_SCAN_STATE_MEASURING;
     }
     break;
@@ -1325,6 +1495,9 @@ void RADIO_UpdateMultiwatch(RadioState *state) {
            !active->msm.open) &&
           scanned->msm.rssi > 0;
 
+      if (scanned->msm.open) {
+        scanned->last_activity_time = Now();
+      }
       if (should_switch) {
         RADIO_SwitchVFO(state, current_scan_vfo);
       }
@@ -1335,8 +1508,10 @@ void RADIO_UpdateMultiwatch(RadioState *state) {
       }
       if (scanned->msm.open) {
         // Log("OPEN!!!");
+        scanned->last_activity_time = Now();
         state->scan_state = RADIO_SCAN_STATE_WARMUP;
         last_scan_time = Now();
+        dwell = SQL_DELAY; // слушаем, не переключаемся
         return;
       }
     }
@@ -1386,9 +1561,7 @@ void RADIO_LoadVFOs(RadioState *state) {
   state->num_vfos = vfoIdx;
 
   VFOContext *ctx = &state->vfos[state->active_vfo_index].context;
-  for (uint8_t p = 0; p < PARAM_COUNT; ++p) {
-    ctx->dirty[p] = true;
-  }
+  ctx->dirty = PARAM_ALL_MASK;
 
   RADIO_ApplySettings(ctx);
 
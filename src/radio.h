@@ -58,6 +58,9 @@ typedef const enum {
   PARAM_COUNT
 } ParamType;
 
+#define PARAM_BIT(p) (1UL << (p))
+#define PARAM_ALL_MASK (PARAM_BIT(PARAM_COUNT) - 1)
+
 typedef enum {
   TX_UNKNOWN,
   TX_ON,
@@ -107,7 +110,7 @@ typedef struct {
   ModulationType modulation;    // Текущая модуляция
   uint8_t volume;               // Громкость
   const FreqBand *current_band; // Активный диапазон
-  bool dirty[PARAM_COUNT];      // Флаги изменений
+  uint32_t dirty;               // Маска изменений, PARAM_BIT(param)
   Code code;
   Step step;
   Squelch squelch;
@@ -119,6 +122,7 @@ typedef struct {
   XtalMode xtal;
 
   bool preciseFChange;
+  bool snapshot_dirty; // Снимок регистров BK4819 устарел
 
   bool save_to_eeprom; // Флаг необходимости сохранения в EEPROM
 } VFOContext;
@@ -133,6 +137,7 @@ typedef struct {
   uint32_t last_activity_time; // for multiwatch
   uint16_t channel_index;      // Channel index if in channel mode
   uint16_t vfo_ch_index;       // MR index of VFO
+  uint8_t dwell;               // Learned multiwatch warmup, ms (0 = default)
   VFOMode mode;                // VFO or channel mode
   bool is_active;              // Whether this is the active VFO
   bool is_open;
@@ -142,6 +147,7 @@ typedef struct {
 typedef struct {
   ExtendedVFOContext vfos[MAX_VFOS]; // Array of VFOs
   uint32_t last_scan_time;           // Last scan time
+  uint16_t cycle_time;               // Last multiwatch cycle duration, ms
   uint8_t num_vfos;                  // Number of configured VFOs
   uint8_t active_vfo_index;          // Currently active VFO
   uint8_t primary_vfo_index;         //
@@ -160,9 +166,14 @@ void RADIO_SaveVFOToStorage(const RadioState *state, uint8_t vfo_index,
                             VFO *storage);
 void RADIO_LoadChannelToVFO(RadioState *state, uint8_t vfo_index,
                             uint16_t channel_index);
+void RADIO_ChannelToVFO(RadioState *state, uint8_t vfo_index,
+                        uint16_t channel_index, const CH *ch);
+void RADIO_ChannelToContext(VFOContext *ctx, const CH *ch);
 bool RADIO_SaveCurrentVFO(RadioState *state);
 void RADIO_ToggleMultiwatch(RadioState *state, bool enable);
 void RADIO_UpdateMultiwatch(RadioState *state);
+uint8_t RADIO_GetMultiwatchDwell(const RadioState *state, uint8_t i);
+bool RADIO_IsMultiwatchIdle(const RadioState *state);
 bool RADIO_ToggleVFOMode(RadioState *state, uint8_t vfo_index);
 
 // Инициализация
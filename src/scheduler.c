@@ -1,9 +1,21 @@
 #include "scheduler.h"
+#include "driver/systick.h"
 
 static uint32_t elapsedMilliseconds = 0;
 
 uint32_t Now(void) { return elapsedMilliseconds; }
 
+// Для интервалов короче миллисекунды; разность верна и при переполнении
+uint32_t NowUs(void) {
+  const volatile uint32_t *ms = &elapsedMilliseconds;
+  uint32_t t, us;
+  do {
+    t = *ms;
+    us = SYSTICK_GetTickUs();
+  } while (t != *ms);
+  return t * 1000 + us;
+}
+
 void SetTimeout(uint32_t *v, uint32_t t) {
   *v = t == UINT32_MAX ? UINT32_MAX : Now() + t;
 }
@@ -205,6 +205,8 @@ uint32_t SETTINGS_GetValue(Setting s) {
     return gSettings.noListen;
   case SETTING_SI4732POWEROFF:
     return gSettings.si4732PowerOff;
+  case SETTING_SI4732KEEPSSB:
+    return gSettings.si4732KeepSsb;
   case SETTING_TONELOCAL:
     return gSettings.toneLocal;
   }
@@ -333,6 +335,9 @@ void SETTINGS_SetValue(Setting s, uint32_t v) {
   case SETTING_SI4732POWEROFF:
     gSettings.si4732PowerOff = v;
     break;
+  case SETTING_SI4732KEEPSSB:
+    gSettings.si4732KeepSsb = v;
+    break;
   case SETTING_TONELOCAL:
     gSettings.toneLocal = v;
     break;
@@ -354,6 +359,7 @@ const char *SETTINGS_GetValueString(Setting s) {
   case SETTING_SHOWLEVELINVFO:
   case SETTING_NOLISTEN:
   case SETTING_SI4732POWEROFF:
+  case SETTING_SI4732KEEPSSB:
   case SETTING_TONELOCAL:
   case SETTING_SKIPGARBAGEFREQUENCIES:
   case SETTING_DTMFDECODE:
@@ -446,6 +452,7 @@ void SETTINGS_IncDecValue(Setting s, bool inc) {
   case SETTING_SHOWLEVELINVFO:
   case SETTING_NOLISTEN:
   case SETTING_SI4732POWEROFF:
+  case SETTING_SI4732KEEPSSB:
   case SETTING_TONELOCAL:
   case SETTING_SKIPGARBAGEFREQUENCIES:
   case SETTING_DTMFDECODE:
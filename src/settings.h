@@ -45,6 +45,7 @@ typedef enum {
   SETTING_BOUND240_280,
   SETTING_NOLISTEN,
   SETTING_SI4732POWEROFF,
+  SETTING_SI4732KEEPSSB,
   SETTING_TONELOCAL,
   SETTING_FCTIME,
   SETTING_MULTIWATCH,
@@ -165,7 +166,8 @@ typedef struct {
   bool si4732PowerOff : 1;
   uint8_t mWatch : 2;
 
-  uint8_t reserved6;
+  bool si4732KeepSsb : 1;
+  uint8_t reserved6 : 7;
 
   BacklightOnSquelchMode backlightOnSquelch : 2;
   bool toneLocal : 1;
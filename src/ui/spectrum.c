@@ -1,20 +1,46 @@
 #include "spectrum.h"
+#include "../driver/st7565.h"
 #include "../driver/uart.h"
 #include "../helper/measurements.h"
+#include "../scheduler.h"
 #include "components.h"
 #include "graphics.h"
 #include <stdint.h>
+#include <string.h>
 
 #define MAX_POINTS 128
 
+#define NF_REGIONS 8          // участки спектра по 16 точек
+#define NF_SHIFT 4            // оценка шума в 1/16 единицы RSSI
+#define NF_GATE (10 << NF_SHIFT) // выше шума на 5 dB - сигнал, не учитываем
+
+#define CACHE_CELLS 512 // ячейка = шаг, для длинных диапазонов - k шагов
+#define CACHE_BLOCK 16
+#define CACHE_FRESH 30 // 3 с, в единицах 100 мс
+
+#define WF_ROWS 24 // 128 x 24 x 2 бита = 768 байт
+#define WF_PAGE 3  // водопад рисуется в страницы 3..5 (y 24..47)
+
 uint8_t SPECTRUM_Y = 8;
 uint8_t SPECTRUM_H = 44;
 GraphMeasurement graphMeasurement = GRAPH_RSSI;
 
 static uint8_t S_BOTTOM;
 
+// Истории - кольцевые буферы: логический x лежит в [(head + x) % MAX_POINTS],
+// сдвиг меняет только head
 static uint16_t rssiHistory[MAX_POINTS] = {0};
 static uint16_t rssiGraphHistory[MAX_POINTS] = {0};
+static uint8_t spHead;
+static uint8_t graphHead;
+
+static inline uint8_t spIdx(uint8_t x) {
+  return (spHead + x) & (MAX_POINTS - 1);
+}
+
+static inline uint8_t graphIdx(uint8_t i) {
+  return (graphHead + i) & (MAX_POINTS - 1);
+}
 
 static uint8_t x = 0;
 static uint8_t ox = UINT8_MAX;
@@ -23,11 +49,146 @@ static uint8_t filledPoints;
 static Band *range;
 static uint16_t step;
 
+// DDA: столбец для растущей частоты считается сложениями, без деления
+typedef struct {
+  uint32_t f;
+  uint32_t acc; // остаток (f - rxF) * (MAX_POINTS - 1) по модулю fRange
+  uint8_t x;
+} ColumnCursor;
+
+static ColumnCursor cursor;
+static uint32_t fRange;
+static uint32_t maxDelta; // больше - acc может переполниться, считаем заново
+
+// Per-frame fixed-point scale instead of a division per column
+typedef struct {
+  uint16_t vMin;
+  uint16_t vMax;
+  uint32_t k; // SPECTRUM_H / (vMax - vMin), 16.16
+} YScale;
+
+// Шум по участкам: EMA по точкам без сигнала, O(1) на точку
+static uint16_t noiseFloor[NF_REGIONS];
+
+// Накопитель режима следа по столбцам, для TRACE_AVG в 1/16 RSSI
+static uint16_t trace[MAX_POINTS];
+static TraceMode traceMode = TRACE_LIVE;
+
+const char *TRACE_MODE_NAMES[TRACE_COUNT] = {"LIVE", "PEAK", "MIN", "AVG"};
+
+// Кэш широкого прохода для зума/сдвига: RSSI / 2 по шагам диапазона.
+// Пока зум внутри кэшированного диапазона с тем же шагом, кэш живёт и
+// дополняется, а спектр нового диапазона сразу собирается из него.
+static struct {
+  uint32_t rxF;
+  uint32_t txF;
+  uint32_t cellHz;
+  uint32_t stepHz;
+  uint32_t f; // курсор записи, как ColumnCursor
+  uint32_t acc;
+  uint16_t cell;
+  uint16_t stored; // последняя записанная ячейка
+  uint16_t blockTime[CACHE_CELLS / CACHE_BLOCK]; // Now() / 100, 0 - пусто
+  uint8_t cells[CACHE_CELLS];
+} cache;
+
+// Водопад: прошлые проходы, 2 бита на точку, кольцевой буфер
+static uint8_t waterfall[WF_ROWS][MAX_POINTS / 4];
+static uint8_t wfHead;
+static uint8_t wfCount;
+
 void SP_ResetHistory(void) {
   filledPoints = 0;
   for (uint8_t i = 0; i < MAX_POINTS; ++i) {
     rssiHistory[i] = 0;
   }
+  for (uint8_t i = 0; i < NF_REGIONS; ++i) {
+    noiseFloor[i] = 0;
+  }
+  for (uint8_t i = 0; i < MAX_POINTS; ++i) {
+    trace[i] = 0;
+  }
+}
+
+// Column value is final for this sweep, fold it into the hold trace
+static void commitColumn(uint8_t x) {
+  const uint8_t i = spIdx(x);
+  const uint16_t v = rssiHistory[i];
+  uint16_t *t = &trace[i];
+  if (!v) {
+    return;
+  }
+  switch (traceMode) {
+  case TRACE_PEAK:
+    if (v > *t) {
+      *t = v;
+    }
+    break;
+  case TRACE_MIN:
+    if (!*t || v < *t) {
+      *t = v;
+    }
+    break;
+  case TRACE_AVG:
+    *t = *t ? *t - (*t >> 3) + (v << 1) : v << 4;
+    break;
+  default:
+    break;
+  }
+}
+
+static uint16_t traceValue(uint8_t x) {
+  const uint8_t i = spIdx(x);
+  switch (traceMode) {
+  case TRACE_LIVE:
+    return rssiHistory[i];
+  case TRACE_AVG:
+    return trace[i] ? trace[i] >> 4 : rssiHistory[i];
+  default:
+    return trace[i] ? trace[i] : rssiHistory[i];
+  }
+}
+
+void SP_SetTraceMode(TraceMode mode) {
+  traceMode = mode;
+  for (uint8_t i = 0; i < MAX_POINTS; ++i) {
+    trace[i] = 0;
+  }
+}
+
+void SP_NextTraceMode(bool next) {
+  SP_SetTraceMode(IncDecU(traceMode, 0, TRACE_COUNT, next));
+}
+
+TraceMode SP_GetTraceMode() { return traceMode; }
+
+// Column of the strongest point of the displayed trace
+uint8_t SP_GetPeakX() {
+  uint8_t px = 0;
+  for (uint8_t i = 1; i < filledPoints; ++i) {
+    if (traceValue(i) > traceValue(px)) {
+      px = i;
+    }
+  }
+  return px;
+}
+
+uint16_t SP_GetTraceValue(uint8_t x) { return traceValue(x); }
+
+static void updateNoiseFloor(uint8_t x, uint16_t rssi) {
+  if (!rssi) {
+    return;
+  }
+  uint16_t *nf = &noiseFloor[x * NF_REGIONS / MAX_POINTS];
+  const uint16_t v = rssi << NF_SHIFT;
+  if (!*nf) {
+    *nf = v;
+  } else if (v < *nf + NF_GATE) {
+    *nf = *nf - (*nf >> 3) + (v >> 3);
+  } else {
+    // медленно подтягиваемся вверх, если шум вырос целиком
+    *nf += 1;
+  }
 }
 
 void SP_Begin(void) {
@@ -35,12 +196,146 @@ void SP_Begin(void) {
   ox = UINT8_MAX;
 }
 
+static void cursorReset(uint32_t f) {
+  const uint64_t n = (uint64_t)(f - range->rxF) * (MAX_POINTS - 1) + fRange / 2;
+  cursor.f = f;
+  cursor.x = fRange ? n / fRange : 0;
+  cursor.acc = fRange ? n - (uint64_t)cursor.x * fRange : 0;
+}
+
+// Same result as SP_F2X(), incremental for a sweep going up
+static uint8_t cursorSeek(uint32_t f) {
+  f = ClampF(f, range->rxF, range->txF);
+  if (f < cursor.f || f - cursor.f > maxDelta) {
+    cursorReset(f);
+    return cursor.x;
+  }
+  cursor.acc += (f - cursor.f) * (MAX_POINTS - 1);
+  cursor.f = f;
+  while (cursor.acc >= fRange && fRange) {
+    cursor.acc -= fRange;
+    cursor.x++;
+  }
+  return cursor.x;
+}
+
+static void cacheSeek(uint32_t f) {
+  if (f < cache.f || f - cache.f > cache.cellHz * 4) {
+    const uint32_t offset = f - cache.rxF;
+    cache.cell = offset / cache.cellHz;
+    cache.acc = offset - cache.cell * cache.cellHz;
+  } else {
+    cache.acc += f - cache.f;
+    while (cache.acc >= cache.cellHz) {
+      cache.acc -= cache.cellHz;
+      cache.cell++;
+    }
+  }
+  cache.f = f;
+}
+
+static uint16_t cacheNow() {
+  const uint16_t t = Now() / 100;
+  return t ? t : 1; // 0 - блок пуст
+}
+
+static bool cacheBlockFresh(uint16_t cell) {
+  const uint16_t t = cache.blockTime[cell / CACHE_BLOCK];
+  return t && (uint16_t)(cacheNow() - t) < CACHE_FRESH;
+}
+
+static void cacheStore(uint32_t f, uint16_t rssi) {
+  if (!cache.cellHz || f < cache.rxF || f > cache.txF) {
+    return;
+  }
+  cacheSeek(f);
+  if (cache.cell < CACHE_CELLS) {
+    const uint8_t v = MIN(rssi >> 1, UINT8_MAX);
+    uint8_t *cell = &cache.cells[cache.cell];
+    // ячейка из k шагов держит максимум за проход, а не последний шаг
+    if (cache.cell != cache.stored || v > *cell) {
+      *cell = v;
+    }
+    cache.stored = cache.cell;
+    cache.blockTime[cache.cell / CACHE_BLOCK] = cacheNow();
+  }
+}
+
+static void cacheReset(const Band *b) {
+  const uint32_t steps = (b->txF - b->rxF) / step + 1;
+  cache.rxF = b->rxF;
+  cache.txF = b->txF;
+  cache.stepHz = step;
+  cache.cellHz = step * ((steps + CACHE_CELLS - 1) / CACHE_CELLS);
+  cache.f = b->rxF;
+  cache.acc = 0;
+  cache.cell = 0;
+  cache.stored = UINT16_MAX;
+  memset(cache.cells, 0, sizeof(cache.cells));
+  memset(cache.blockTime, 0, sizeof(cache.blockTime));
+}
+
+// Свежие ячейки кэша -> столбцы нового диапазона
+static void cacheReproject(const Band *b) {
+  cacheSeek(b->rxF);
+  uint32_t f = cache.rxF + cache.cell * cache.cellHz;
+  for (uint16_t c = cache.cell; c < CACHE_CELLS && f <= b->txF;
+       ++c, f += cache.cellHz) {
+    if (f < b->rxF || !cache.cells[c] || !cacheBlockFresh(c)) {
+      continue;
+    }
+    const uint8_t x = cursorSeek(f);
+    const uint16_t v = cache.cells[c] << 1;
+    if (v > rssiHistory[spIdx(x)]) {
+      rssiHistory[spIdx(x)] = v;
+    }
+    if (x >= filledPoints) {
+      filledPoints = x + 1;
+    }
+  }
+  cursorReset(b->rxF);
+}
+
+// Шаг измерен недавно и его столбец уже показан из кэша. Ячейка из k шагов
+// закрашивает при перепроецировании один столбец, шаги других столбцов
+// надо мерить.
+bool SP_CacheFresh(uint32_t f) {
+  if (!cache.cellHz || f < cache.rxF || f > cache.txF) {
+    return false;
+  }
+  const uint16_t c = (f - cache.rxF) / cache.cellHz;
+  if (c >= CACHE_CELLS || !cache.cells[c] || !cacheBlockFresh(c)) {
+    return false;
+  }
+  if (cache.cellHz == cache.stepHz) {
+    return true;
+  }
+  const uint32_t cellF = cache.rxF + c * cache.cellHz;
+  return cellF >= range->rxF && SP_F2X(cellF) == SP_F2X(f);
+}
+
+static bool cacheCovers(const Band *b) {
+  return cache.cellHz && cache.stepHz == step && b->rxF >= cache.rxF &&
+         b->txF <= cache.txF;
+}
+
 void SP_Init(Band *b) {
   S_BOTTOM = SPECTRUM_Y + SPECTRUM_H;
   range = b;
   step = StepFrequencyTable[b->step];
+  fRange = b->txF > b->rxF ? b->txF - b->rxF : 0;
+  maxDelta = (UINT32_MAX - fRange) / (MAX_POINTS - 1);
+  cursorReset(b->rxF);
+  wfHead = 0;
+  wfCount = 0;
   SP_ResetHistory();
   SP_Begin();
+
+  if (cacheCovers(b)) {
+    cacheReproject(b);
+  } else {
+    cacheReset(b);
+  }
 }
 
 uint8_t SP_F2X(uint32_t f) {
@@ -51,18 +346,29 @@ uint32_t SP_X2F(uint8_t x) {
   return ConvertDomainF(x, 0, MAX_POINTS - 1, range->rxF, range->txF);
 }
 
-void SP_AddPoint(const Measurement *msm) {
-  const uint32_t xs = SP_F2X(msm->f);
-  const uint32_t xe = SP_F2X(msm->f + step);
+void SP_AddPoint(const Measurement *msm) { SP_AddPointSpan(msm, step); }
+
+// Point covering [f, f + span], e.g. coarse sweep bin
+void SP_AddPointSpan(const Measurement *msm, uint32_t span) {
+  const uint32_t xs = cursorSeek(msm->f);
+  const uint32_t xe = cursorSeek(msm->f + span);
+
+  if (xs < MAX_POINTS) {
+    updateNoiseFloor(xs, msm->rssi);
+  }
+  cacheStore(msm->f, msm->rssi);
 
   // TODO: debug this range
   for (x = xs; x < MAX_POINTS && x <= xe; ++x) {
     if (ox != x) {
+      if (ox < MAX_POINTS) {
+        commitColumn(ox);
+      }
       ox = x;
-      rssiHistory[x] = 0;
+      rssiHistory[spIdx(x)] = 0;
     }
-    if (msm->rssi > rssiHistory[x]) {
-      rssiHistory[x] = msm->rssi;
+    if (msm->rssi > rssiHistory[spIdx(x)]) {
+      rssiHistory[spIdx(x)] = msm->rssi;
     }
   }
   // not x+1 as we going to xe inclusive
@@ -74,22 +380,39 @@ void SP_AddPoint(const Measurement *msm) {
   }
 }
 
-static uint16_t MinRSSI(const uint16_t *array, size_t n) {
-  if (array == NULL || n == 0) {
-    return 0;
-  }
-  uint16_t min = array[0];
-  for (size_t i = 1; i < n; ++i) {
-    if (array[i] && array[i] < min) {
-      min = array[i];
+// Min of non-empty points and max over the filled part of the ring
+static VMinMax historyMinMax() {
+  VMinMax mm = {0, 0};
+  for (uint8_t x = 0; x < filledPoints; ++x) {
+    const uint16_t v = rssiHistory[spIdx(x)];
+    if (v && (!mm.vMin || v < mm.vMin)) {
+      mm.vMin = v;
+    }
+    if (v > mm.vMax) {
+      mm.vMax = v;
     }
   }
-  return min;
+  return mm;
+}
+
+static YScale yScale(VMinMax v) {
+  return (YScale){
+      .vMin = v.vMin,
+      .vMax = v.vMax,
+      .k = v.vMax > v.vMin ? ((uint32_t)SPECTRUM_H << 16) / (v.vMax - v.vMin)
+                           : 0,
+  };
+}
+
+static uint8_t yScaled(const YScale *s, uint16_t v) {
+  v = v < s->vMin ? s->vMin : (v > s->vMax ? s->vMax : v);
+  return ((v - s->vMin) * s->k + 0x8000) >> 16;
 }
 
 VMinMax SP_GetMinMax() {
-  const uint16_t rssiMin = MinRSSI(rssiHistory, filledPoints);
-  const uint16_t rssiMax = Max(rssiHistory, filledPoints);
+  const VMinMax mm = historyMinMax();
+  const uint16_t rssiMin = mm.vMin;
+  const uint16_t rssiMax = mm.vMax;
   const uint16_t rssiDiff = rssiMax - rssiMin;
   return (VMinMax){
       .vMin = rssiMin,
@@ -104,12 +427,72 @@ void SP_Render(const Band *p, VMinMax v) {
 
   DrawHLine(0, S_BOTTOM, MAX_POINTS, C_FILL);
 
+  const YScale ys = yScale(v);
   for (uint8_t i = 0; i < filledPoints; ++i) {
-    uint8_t yVal = ConvertDomain(rssiHistory[i], v.vMin, v.vMax, 0, SPECTRUM_H);
+    uint8_t yVal = yScaled(&ys, traceValue(i));
     DrawVLine(i, S_BOTTOM - yVal, yVal, C_FILL);
   }
 }
 
+// Called once per completed sweep, quantises it against the noise floor
+void SP_WaterfallPush() {
+  const uint16_t nf = SP_GetNoiseFloor();
+  uint8_t *row = waterfall[wfHead];
+  memset(row, 0, MAX_POINTS / 4);
+  for (uint8_t i = 0; i < filledPoints; ++i) {
+    const uint16_t v = rssiHistory[spIdx(i)];
+    uint8_t q = v >= nf + 24 ? 3 : v >= nf + 12 ? 2 : v >= nf + 4 ? 1 : 0;
+    row[i >> 2] |= q << ((i & 3) << 1);
+  }
+  wfHead = (wfHead + 1) % WF_ROWS;
+  if (wfCount < WF_ROWS) {
+    wfCount++;
+  }
+}
+
+// Уровень -> плотность точек, сразу в байты страниц дисплея
+static bool wfPixel(uint8_t q, uint8_t x, uint8_t y) {
+  switch (q) {
+  case 3:
+    return true;
+  case 2:
+    return (x ^ y) & 1;
+  case 1:
+    return !(x & 1) && !(y & 1);
+  default:
+    return false;
+  }
+}
+
+void SP_RenderWaterfall(const Band *p) {
+  if (p) {
+    UI_DrawTicks(S_BOTTOM, p);
+  }
+  DrawHLine(0, S_BOTTOM, MAX_POINTS, C_FILL);
+
+  for (uint8_t page = 0; page < WF_ROWS / 8; ++page) {
+    const uint8_t *rows[8];
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      // сверху самый свежий проход
+      const uint8_t age = page * 8 + bit;
+      rows[bit] = age < wfCount
+                      ? waterfall[(wfHead + WF_ROWS - 1 - age) % WF_ROWS]
+                      : NULL;
+    }
+    uint8_t *out = gFrameBuffer[WF_PAGE + page];
+    for (uint8_t x = 0; x < MAX_POINTS; ++x) {
+      uint8_t b = 0;
+      for (uint8_t bit = 0; bit < 8; ++bit) {
+        if (rows[bit] &&
+            wfPixel((rows[bit][x >> 2] >> ((x & 3) << 1)) & 3, x, bit)) {
+          b |= 1 << bit;
+        }
+      }
+      out[x] |= b;
+    }
+  }
+}
+
 void SP_RenderArrow(const Band *p, uint32_t f) {
   uint8_t cx = SP_F2X(f);
   DrawVLine(cx, SPECTRUM_Y + SPECTRUM_H + 1, 1, C_FILL);
@@ -129,10 +512,22 @@ void SP_RenderLine(uint16_t rssi, VMinMax v) {
   DrawHLine(0, S_BOTTOM - yVal, filledPoints, C_FILL);
 }
 
-uint16_t SP_GetNoiseFloor() { return Std(rssiHistory, filledPoints); }
-uint16_t SP_GetRssiMax() { return Max(rssiHistory, filledPoints); }
+uint16_t SP_GetNoiseFloor() {
+  uint32_t sum = 0;
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < NF_REGIONS; ++i) {
+    if (noiseFloor[i]) {
+      sum += noiseFloor[i];
+      n++;
+    }
+  }
+  return n ? (sum / n) >> NF_SHIFT : 0;
+}
+uint16_t SP_GetRssiMax() { return historyMinMax().vMax; }
 
-uint16_t SP_GetLastGraphValue() { return rssiGraphHistory[MAX_POINTS - 1]; }
+uint16_t SP_GetLastGraphValue() {
+  return rssiGraphHistory[graphIdx(MAX_POINTS - 1)];
+}
 
 void SP_RenderGraph(uint16_t min, uint16_t max) {
   const VMinMax v = {
@@ -145,12 +540,11 @@ void SP_RenderGraph(uint16_t min, uint16_t max) {
 
   FillRect(0, SPECTRUM_Y, LCD_WIDTH, SPECTRUM_H, C_CLEAR);
 
-  uint8_t oVal =
-      ConvertDomain(rssiGraphHistory[0], v.vMin, v.vMax, 0, SPECTRUM_H);
+  const YScale ys = yScale(v);
+  uint8_t oVal = yScaled(&ys, rssiGraphHistory[graphIdx(0)]);
 
   for (uint8_t i = 1; i < MAX_POINTS; ++i) {
-    uint8_t yVal =
-        ConvertDomain(rssiGraphHistory[i], v.vMin, v.vMax, 0, SPECTRUM_H);
+    uint8_t yVal = yScaled(&ys, rssiGraphHistory[graphIdx(i)]);
     DrawLine(i - 1, S_BOTTOM - oVal, i, S_BOTTOM - yVal, C_FILL);
     oVal = yVal;
   }
@@ -193,33 +587,53 @@ void SP_AddGraphPoint(const Measurement *msm) {
     break;
   }
 
-  rssiGraphHistory[MAX_POINTS - 1] = v;
+  rssiGraphHistory[graphIdx(MAX_POINTS - 1)] = v;
   filledPoints = MAX_POINTS;
 }
 
-static void shiftEx(uint16_t *history, uint16_t n, int16_t shift) {
-  if (shift == 0) {
-    return;
+// Moves the logical window of a ring history and clears the vacated slots:
+// O(|shift|) instead of moving every element per shift unit.
+// Returns the new head.
+static uint8_t shiftEx(uint16_t *history, uint8_t head, int16_t shift) {
+  if (shift > MAX_POINTS) {
+    shift = MAX_POINTS;
+  } else if (shift < -MAX_POINTS) {
+    shift = -MAX_POINTS;
   }
-  if (shift > 0) {
-    while (shift-- > 0) {
-      for (int16_t i = n - 2; i >= 0; --i) {
-        history[i + 1] = history[i];
-      }
-      history[0] = 0;
-    }
-  } else {
-    while (shift++ < 0) {
-      for (int16_t i = 0; i < n - 1; ++i) {
-        history[i] = history[i + 1];
-      }
-      history[MAX_POINTS - 1] = 0;
-    }
+  head = (head - shift) & (MAX_POINTS - 1);
+  const uint8_t from = shift > 0 ? 0 : MAX_POINTS + shift;
+  const uint8_t n = shift > 0 ? shift : -shift;
+  for (uint8_t i = 0; i < n; ++i) {
+    history[(head + from + i) & (MAX_POINTS - 1)] = 0;
+  }
+  return head;
+}
+
+void SP_Shift(int16_t n) {
+  // след двигается вместе со спектром
+  shiftEx(trace, spHead, n);
+  spHead = shiftEx(rssiHistory, spHead, n);
+}
+
+// Диапазон той же ширины сдвинут на n столбцов (n > 0 - вверх по частоте):
+// измеренное остаётся на экране, открывшиеся столбцы пустые до замера
+void SP_Pan(Band *b, int16_t n) {
+  range = b;
+  SP_Shift(-n);
+  if (n < 0) {
+    filledPoints = MIN(filledPoints - n, MAX_POINTS);
+  }
+  wfCount = 0; // строки водопада по старым столбцам
+  cursorReset(b->rxF);
+  SP_Begin();
+  if (!cacheCovers(b)) {
+    cacheReset(b);
   }
 }
 
-void SP_Shift(int16_t n) { shiftEx(rssiHistory, MAX_POINTS, n); }
-void SP_ShiftGraph(int16_t n) { shiftEx(rssiGraphHistory, MAX_POINTS, n); }
+void SP_ShiftGraph(int16_t n) {
+  graphHead = shiftEx(rssiGraphHistory, graphHead, n);
+}
 
 static uint8_t curX = MAX_POINTS / 2;
 static uint8_t curSbWidth = 16;
@@ -21,7 +21,16 @@ typedef enum {
   GRAPH_COUNT,
 } GraphMeasurement;
 
+typedef enum {
+  TRACE_LIVE,
+  TRACE_PEAK,
+  TRACE_MIN,
+  TRACE_AVG,
+  TRACE_COUNT,
+} TraceMode;
+
 void SP_AddPoint(const Measurement *msm);
+void SP_AddPointSpan(const Measurement *msm, uint32_t span);
 void SP_ResetHistory();
 void SP_Init(Band *b);
 void SP_Begin();
@@ -29,6 +38,8 @@ void SP_Render(const Band *p, VMinMax v);
 void SP_RenderRssi(uint16_t rssi, char *text, bool top, VMinMax v);
 void SP_RenderLine(uint16_t rssi, VMinMax v);
 void SP_RenderArrow(const Band *p, uint32_t f);
+void SP_WaterfallPush();
+void SP_RenderWaterfall(const Band *p);
 uint16_t SP_GetNoiseFloor();
 uint16_t SP_GetRssiMax();
 VMinMax SP_GetMinMax();
@@ -37,10 +48,19 @@ void SP_NextGraphUnit(bool next);
 void SP_RenderGraph(uint16_t min, uint16_t max);
 void SP_AddGraphPoint(const Measurement *msm);
 void SP_Shift(int16_t n);
+void SP_Pan(Band *b, int16_t n);
 void SP_ShiftGraph(int16_t n);
 uint16_t SP_GetLastGraphValue();
 
 uint8_t SP_F2X(uint32_t f);
+uint32_t SP_X2F(uint8_t x);
+bool SP_CacheFresh(uint32_t f);
+
+void SP_SetTraceMode(TraceMode mode);
+void SP_NextTraceMode(bool next);
+TraceMode SP_GetTraceMode();
+uint8_t SP_GetPeakX();
+uint16_t SP_GetTraceValue(uint8_t x);
 
 void CUR_Render();
 bool CUR_Move(bool up);
@@ -52,5 +72,6 @@ bool CUR_Size(bool up);
 extern uint8_t SPECTRUM_Y;
 extern uint8_t SPECTRUM_H;
 extern GraphMeasurement graphMeasurement;
+extern const char *TRACE_MODE_NAMES[TRACE_COUNT];
 
 #endif /* end of include guard: UI_SPECTRUM_H */
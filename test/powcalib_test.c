@@ -0,0 +1,50 @@
+// Host test of POWCALIB_Interpolate: make test
+#include "helper/powcalib.h"
+#include <stdio.h>
+
+static int failed;
+
+static void expect(uint32_t f, PowerCalibration want) {
+  const PowerCalibration got = POWCALIB_Interpolate(f);
+  if (got.s != want.s || got.m != want.m || got.e != want.e) {
+    printf("FAIL %u: got %u/%u/%u, want %u/%u/%u\n", f, got.s, got.m, got.e,
+           want.s, want.m, want.e);
+    failed++;
+  }
+}
+
+// Calibration point of a range, same rounding as in powcalib.c
+static uint32_t center(uint32_t s, uint32_t e) {
+  return (s / 2 + e / 2) / 1000 * 1000;
+}
+
+int main(void) {
+  const PowerCalibration def = {43, 68, 140};
+
+  // centres give exact table values
+  expect(center(13500000, 16499999), (PowerCalibration){38, 65, 140});
+  expect(center(21500000, 21999999), (PowerCalibration){44, 46, 50});
+  expect(center(27500000, 28499999), (PowerCalibration){81, 107, 140});
+  expect(center(36500000, 46999999), def);
+  expect(center(47000000, 61999999), (PowerCalibration){46, 77, 140});
+
+  // outside the table - default
+  expect(0, def);
+  expect(13499999, def);
+  expect(62000000, def);
+  expect(130000000, def);
+
+  // table edges: end values of the first / last range
+  expect(13500000, (PowerCalibration){38, 65, 140});
+  expect(61999999, (PowerCalibration){46, 77, 140});
+
+  // 167.5 MHz: between 150 MHz {38, 65, 140} and 185 MHz {36, 52, 140}
+  expect(16750000, (PowerCalibration){37, 58, 140});
+
+  if (failed) {
+    printf("%d failed\n", failed);
+    return 1;
+  }
+  printf("powcalib: ok\n");
+  return 0;
+}